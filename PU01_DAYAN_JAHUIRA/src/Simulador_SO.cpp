@@ -1,12 +1,36 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <vector>
 #include <deque>
 #include <string>
 #include <algorithm>
 #include <stdexcept>
 #include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include <queue>
+#include <functional>
+#include <tuple>
+#include <map>
+#include <numeric>
+#include <set>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <charconv>
+#include <string_view>
 #include "../config/json.hpp"
 using json = nlohmann::json;
 using namespace std;
@@ -18,12 +42,36 @@ struct Process {
     int inicio = -1;
     int fin = -1;
     int restante = 0;
+    int mem = 0;      // bytes asignados en este momento
+    int espera_mem = 0; // tiempo bloqueado esperando memoria (control de admision)
+    int ref_ini = 0;  // cadena de referencias: referencias[ref_ini .. ref_ini+ref_n)
+    int ref_n = 0;
+    int prioridad = 0;      // mayor numero = menor prioridad
+    int listo_desde = 0;    // ultima vez que entro a la cola de listos
+    bool suspendido = false;  // sacado de memoria por el intercambio
+    bool en_cola = false;     // tiene una entrada en la cola de listos
+    bool en_io = false;       // esperando o usando un dispositivo
+    bool admitido = false;    // el control de admision ya le reservo memoria alguna vez
+    int64_t raf_ini = 0;  // rafagas[raf_ini .. raf_ini+raf_n): CPU, E/S, CPU, ..., CPU (puede pasar de INT_MAX)
+    int raf_n = 0;
+    int raf_actual = 0;   // rafaga de CPU en curso
+    int raf_resto = 0;    // lo que le falta a esa rafaga
+    int io = 0;           // tiempo total desde cada pedido de E/S hasta su fin
+    int particion = 0;    // grupo independiente (cluster o cola propia)
     int respuesta() const { return inicio - llegada; }
-    int espera() const { return fin - llegada - servicio; }
+    int espera() const { return fin - llegada - servicio - io; }
     int retorno() const { return fin - llegada; }
 };
 
-struct MemReq { int pid; int tam; int block_id = -1; };
+struct MemReq {
+    int pid;
+    int tam;
+    int block_id = -1;
+    int tiempo = -1;  // -1: se pide al llegar el proceso
+};
+
+// Rafaga de un proceso; en las de E/S se usan tambien el dispositivo y la pista.
+struct Rafaga { int dur; int disp = 0; int pista = 0; };
 
 struct Block {
     int id;
@@ -35,6 +83,13 @@ struct Block {
 
 enum class AlgCPU { FCFS, SPN, RR };
 enum class AlgMem { FIRST_FIT, BEST_FIT, WORST_FIT, NEXT_FIT };
+// INICIAL: todas las solicitudes se asignan antes de planificar y no se liberan.
+// TEMPORAL: se asignan en la linea de tiempo y se liberan al terminar el proceso.
+enum class ModoMem { INICIAL, TEMPORAL };
+// Que hacer cuando una asignacion falla pero el total libre alcanza.
+enum class Compactacion { NO, TOTAL, INCREMENTAL };
+// A quien suspender cuando falta memoria para admitir un proceso.
+enum class Victima { NINGUNA, MAYOR, PRIORIDAD, ESPERA };
 
 string algCPUToStr(AlgCPU a) {
     if (a==AlgCPU::FCFS) return "FCFS";
@@ -48,8 +103,748 @@ string algMemToStr(AlgMem m) {
     return "Next-Fit";
 }
 
+// Vector compartido entre copias del Simulator hasta que alguna lo modifica
+// (solo la carga escribe; las simulaciones lo leen).
+template <class T>
+class Cow {
+    shared_ptr<vector<T>> v = make_shared<vector<T>>();
+public:
+    const T &operator[](size_t i) const { return (*v)[i]; }
+    size_t size() const { return v->size(); }
+    bool empty() const { return v->empty(); }
+    const T *data() const { return v->data(); }
+    typename vector<T>::const_iterator begin() const { return v->cbegin(); }
+    typename vector<T>::const_iterator end() const { return v->cend(); }
+    vector<T> &mut() {
+        if (v.use_count() > 1) v = make_shared<vector<T>>(*v);
+        return *v;
+    }
+};
+
+// Buffer circular de capacidad fija: al llenarse pisa la muestra mas vieja.
+template <class T>
+struct Anillo {
+    vector<T> buf;
+    size_t ini = 0, n = 0;
+    explicit Anillo(size_t cap = 0) : buf(cap) {}
+    void push(const T &x) {
+        if (buf.empty()) return;
+        buf[(ini + n) % buf.size()] = x;
+        if (n < buf.size()) n++;
+        else ini = (ini + 1) % buf.size();
+    }
+    size_t size() const { return n; }
+    const T &operator[](size_t i) const { return buf[(ini + i) % buf.size()]; }
+};
+
+// Reparte los indices [0, n) entre los hilos disponibles y llama f(i) para cada uno.
+// Una llamada anidada (desde dentro de f) corre en el hilo que la hace.
+inline thread_local bool en_paralelo = false;
+
+template <class F>
+void paraleloPara(size_t n, F f) {
+    if (en_paralelo) { for (size_t i = 0; i < n; ++i) f(i); return; }
+    size_t h = min<size_t>(max(1u, thread::hardware_concurrency()), n);
+    atomic<size_t> sig{0};
+    auto trabajo = [&]() {
+        en_paralelo = true;
+        for (size_t i; (i = sig++) < n; ) f(i);
+        en_paralelo = false;
+    };
+    vector<thread> hilos;
+    for (size_t k = 1; k < h; ++k) hilos.emplace_back(trabajo);
+    trabajo();
+    for (auto &t : hilos) t.join();
+}
+
+// xoshiro256** sembrado con splitmix64: barato de crear, uno por bloque de trabajo.
+struct Rng {
+    uint64_t s[4];
+    explicit Rng(uint64_t semilla) {
+        for (auto &x : s) {
+            uint64_t z = (semilla += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            x = z ^ (z >> 31);
+        }
+    }
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t operator()() {
+        uint64_t r = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t; s[3] = rotl(s[3], 45);
+        return r;
+    }
+    double uniforme() { return ((*this)() >> 11) * 0x1.0p-53; }   // [0,1)
+    double exponencial(double media) { return -log1p(-uniforme()) * media; }
+    double normal() { return sqrt(-2.0 * log1p(-uniforme())) * cos(2 * M_PI * uniforme()); }
+};
+
+// Distribucion de un parametro del generador, leida de {"tipo": ..., parametros}.
+struct Distribucion {
+    enum Tipo { CONSTANTE, EXPONENCIAL, PARETO, BIMODAL, LOGNORMAL } tipo = CONSTANTE;
+    double a = 1, b = 1, p = 0;
+
+    static Distribucion leer(const json &j) {
+        Distribucion d;
+        string t = j.value("tipo", "constante");
+        if (t == "constante") { d.tipo = CONSTANTE; d.a = j.value("valor", 1.0); }
+        else if (t == "exponencial") { d.tipo = EXPONENCIAL; d.a = j.value("media", 10.0); }
+        else if (t == "pareto") { d.tipo = PARETO; d.a = j.value("alfa", 1.5); d.b = j.value("min", 1.0); }
+        else if (t == "bimodal") {
+            d.tipo = BIMODAL;
+            d.a = j.value("corto", 2.0); d.b = j.value("largo", 50.0); d.p = j.value("prob_largo", 0.1);
+        }
+        else if (t == "lognormal") { d.tipo = LOGNORMAL; d.a = j.value("mu", 10.0); d.b = j.value("sigma", 1.0); }
+        else throw runtime_error("Distribucion desconocida: " + t);
+        return d;
+    }
+
+    double muestra(Rng &r) const {
+        switch (tipo) {
+            case CONSTANTE: return a;
+            case EXPONENCIAL: return r.exponencial(a);
+            case PARETO: return b / pow(1.0 - r.uniforme(), 1.0 / a);
+            case BIMODAL: return r.uniforme() < p ? r.exponencial(b) : r.exponencial(a);
+            default: return exp(a + b * r.normal());
+        }
+    }
+};
+
+// Carga sintetica: "generador" en el JSON reemplaza a "procesos"/"solicitudes_mem".
+// Se genera por bloques en paralelo; cada bloque tiene sus propias semillas, asi
+// que el resultado depende solo de la semilla y no del numero de hilos.
+struct Generador {
+    long long n = 0;
+    uint64_t semilla = 1;
+    bool rafagas = false;       // llegadas "poisson" o "rafagas"
+    double tasa = 1.0;          // llegadas (o rafagas) por unidad de tiempo
+    double tam_rafaga = 1.0;    // tamano medio de una rafaga
+    Distribucion servicio, tam_mem;
+    double prob_mem = 0;        // probabilidad de que un proceso pida memoria
+    bool con_refs = false;      // cadenas de referencias a paginas
+    Distribucion refs_longitud;
+    int refs_paginas = 64;      // paginas virtuales por proceso
+    double refs_localidad = 0.9; // probabilidad de quedarse cerca de la pagina anterior
+    int rafagas_io = 0;         // rafagas de E/S por proceso
+    Distribucion dur_io;
+    int dispositivos = 1, pistas = 200;
+    int particiones = 1;        // los procesos se reparten al azar entre grupos independientes
+
+    static constexpr size_t BLOQUE = 1 << 16;
+
+    static Generador leer(const json &g) {
+        Generador G;
+        G.n = g.value("procesos", 0LL);
+        G.semilla = g.value("semilla", 1ULL);
+        if (g.contains("llegadas")) {
+            auto &l = g["llegadas"];
+            string t = l.value("tipo", "poisson");
+            if (t == "rafagas") G.rafagas = true;
+            else if (t != "poisson") throw runtime_error("Llegadas desconocidas: " + t);
+            G.tasa = l.value("tasa", 1.0);
+            G.tam_rafaga = max(1.0, l.value("tam_rafaga", 1.0));
+        }
+        G.servicio.tipo = Distribucion::EXPONENCIAL;
+        G.servicio.a = 10;
+        if (g.contains("servicio")) G.servicio = Distribucion::leer(g["servicio"]);
+        if (g.contains("memoria")) {
+            G.tam_mem = Distribucion::leer(g["memoria"]);
+            G.prob_mem = g["memoria"].value("prob", 1.0);
+        }
+        if (g.contains("referencias")) {
+            auto &r = g["referencias"];
+            G.con_refs = true;
+            G.refs_longitud.a = 100;
+            if (r.contains("longitud")) G.refs_longitud = Distribucion::leer(r["longitud"]);
+            G.refs_paginas = max(1, r.value("paginas", 64));
+            G.refs_localidad = r.value("localidad", 0.9);
+        }
+        if (g.contains("io")) {
+            auto &x = g["io"];
+            G.rafagas_io = max(0, x.value("rafagas", 1));
+            G.dur_io.tipo = Distribucion::EXPONENCIAL;
+            G.dur_io.a = 5;
+            if (x.contains("duracion")) G.dur_io = Distribucion::leer(x["duracion"]);
+            G.dispositivos = max(1, x.value("dispositivos", 1));
+            G.pistas = max(1, x.value("pistas", 200));
+        }
+        G.particiones = max(1, g.value("particiones", 1));
+        if (G.n < 0 || G.tasa <= 0) throw runtime_error("Parametros de generador invalidos");
+        return G;
+    }
+
+    Rng flujo(size_t bloque, int k) const { return Rng(semilla * 0x9e3779b97f4a7c15ULL + bloque * 8 + k); }
+
+    double intervalo(Rng &r) const {   // dentro de una rafaga las llegadas coinciden
+        if (rafagas && r.uniforme() < 1.0 - 1.0 / tam_rafaga) return 0;
+        return r.exponencial(1.0 / tasa);
+    }
+
+    int longitudRefs(Rng &r) const { return con_refs ? (int)max(0.0, round(refs_longitud.muestra(r))) : 0; }
+
+    // Paso 1 de un bloque: suma de sus intervalos y cantidad de solicitudes y referencias.
+    struct Totales { double t = 0; size_t m = 0, nr = 0; };
+    Totales contarBloque(size_t b) const {
+        size_t ini = b * BLOQUE, fin = min<size_t>(n, ini + BLOQUE);
+        Rng rl = flujo(b, 0), rm = flujo(b, 2), rr = flujo(b, 3);
+        Totales r;
+        for (size_t i = ini; i < fin; ++i) {
+            r.t += intervalo(rl);
+            if (rm.uniforme() < prob_mem) { r.m++; tam_mem.muestra(rm); }
+            r.nr += longitudRefs(rr);
+        }
+        return r;
+    }
+
+    // Paso 2 de un bloque: sus procesos van a procesos[0..], empezando en el
+    // instante t y en las posiciones m y nr de solicitudes y referencias. Las
+    // rafagas se indexan por el numero global del proceso.
+    void generarBloque(size_t b, double t, size_t m, size_t nr, Process *procesos, MemReq *solicitudes,
+                       int *referencias, Rafaga *rafagas, int memoria_size) const {
+        size_t ini = b * BLOQUE, fin = min<size_t>(n, ini + BLOQUE);
+        int nraf = rafagas_io > 0 ? 2 * rafagas_io + 1 : 0;
+        Rng rl = flujo(b, 0), rs = flujo(b, 1), rm = flujo(b, 2), rr = flujo(b, 3), rp = flujo(b, 4);
+        Rng ri = flujo(b, 5), rg = flujo(b, 6);
+        for (size_t i = ini; i < fin; ++i) {
+            t += intervalo(rl);
+            Process &p = procesos[i - ini];
+            p.pid = (int)i + 1;
+            p.llegada = (int)min(t, (double)INT_MAX / 2);
+            p.servicio = (int)max(1.0, min(round(servicio.muestra(rs)), (double)INT_MAX / 4));
+            p.restante = p.servicio;
+            if (particiones > 1) p.particion = (int)(rg() % particiones);
+            if (rm.uniforme() < prob_mem) {
+                double tam = tam_mem.muestra(rm);
+                solicitudes[m].pid = p.pid;
+                solicitudes[m].tam = (int)max(1.0, min(round(tam), (double)memoria_size));
+                m++;
+            }
+            p.ref_ini = (int)nr;
+            p.ref_n = longitudRefs(rr);
+            int pag = (int)(rp() % refs_paginas);
+            for (int k = 0; k < p.ref_n; ++k) {
+                if (rp.uniforme() < refs_localidad) pag = (pag + (int)(rp() % 3) - 1 + refs_paginas) % refs_paginas;
+                else pag = (int)(rp() % refs_paginas);
+                referencias[nr++] = pag;
+            }
+            if (nraf) {   // el servicio se reparte entre rafagas_io + 1 rafagas de CPU
+                p.raf_ini = (int64_t)i * nraf;
+                p.raf_n = nraf;
+                Rafaga *r = &rafagas[p.raf_ini];
+                int cpu = rafagas_io + 1;
+                p.servicio = max(p.servicio, cpu);
+                p.restante = p.servicio;
+                for (int k = 0; k < nraf; ++k) {
+                    if (k % 2 == 0) r[k].dur = p.servicio / cpu + (k / 2 < p.servicio % cpu);
+                    else {
+                        r[k].dur = (int)max(1.0, round(dur_io.muestra(ri)));
+                        r[k].disp = (int)(ri() % dispositivos);
+                        r[k].pista = (int)(ri() % pistas);
+                    }
+                }
+            }
+        }
+    }
+
+    void generar(vector<Process> &procesos, vector<MemReq> &solicitudes, vector<int> &referencias,
+                 vector<Rafaga> &rafagas, int memoria_size) const {
+        size_t nb = (n + BLOQUE - 1) / BLOQUE;
+        vector<double> t0(nb + 1, 0);
+        vector<size_t> m0(nb + 1, 0), r0(nb + 1, 0);
+        paraleloPara(nb, [&](size_t b) {
+            Totales r = contarBloque(b);
+            t0[b + 1] = r.t; m0[b + 1] = r.m; r0[b + 1] = r.nr;
+        });
+        for (size_t b = 0; b < nb; ++b) { t0[b + 1] += t0[b]; m0[b + 1] += m0[b]; r0[b + 1] += r0[b]; }
+        if (r0[nb] > (size_t)INT_MAX) throw runtime_error("Demasiadas referencias generadas");
+
+        // Se regeneran los mismos flujos escribiendo en su posicion final.
+        procesos.assign(n, Process{});
+        solicitudes.assign(m0[nb], MemReq{});
+        referencias.assign(r0[nb], 0);
+        int nraf = rafagas_io > 0 ? 2 * rafagas_io + 1 : 0;   // cantidad fija: no necesita paso 1
+        rafagas.assign(nraf * (size_t)n, Rafaga{0});
+        paraleloPara(nb, [&](size_t b) {
+            generarBloque(b, t0[b], m0[b], r0[b], procesos.data() + b * BLOQUE, solicitudes.data(),
+                          referencias.data(), rafagas.data(), memoria_size);
+        });
+    }
+};
+
+// Reemplazo de paginas sobre una traza de paginas ya densas (0 .. paginas-1).
+// Todos los algoritmos son O(1) por referencia salvo el optimo, O(log marcos).
+struct Reemplazo {
+    enum Alg { FIFO, LRU, CLOCK, OPT };
+
+    static string nombre(Alg a) {
+        const char *n[] = {"FIFO", "LRU", "CLOCK", "Optimo"};
+        return n[a];
+    }
+    static Alg leer(const string &s) {
+        if (s == "FIFO") return FIFO;
+        if (s == "LRU") return LRU;
+        if (s == "CLOCK") return CLOCK;
+        if (s == "OPT" || s == "Optimo") return OPT;
+        throw runtime_error("Algoritmo de reemplazo desconocido: " + s);
+    }
+
+    static long long fallos(Alg a, const vector<int> &traza, int paginas, int marcos) {
+        if (marcos <= 0) return traza.size();
+        if (a == FIFO) return fifo(traza, paginas, marcos);
+        if (a == LRU) return lru(traza, paginas, marcos);
+        if (a == CLOCK) return reloj(traza, paginas, marcos);
+        return optimo(traza, paginas, marcos);
+    }
+
+    static long long fifo(const vector<int> &traza, int paginas, int marcos) {
+        vector<char> presente(paginas, 0);
+        vector<int> cola(marcos);
+        int usados = 0, h = 0;
+        long long f = 0;
+        for (int p : traza) {
+            if (presente[p]) continue;
+            f++;
+            if (usados < marcos) cola[usados++] = p;
+            else { presente[cola[h]] = 0; cola[h] = p; h = h + 1 == marcos ? 0 : h + 1; }
+            presente[p] = 1;
+        }
+        return f;
+    }
+
+    // Lista doblemente enlazada sobre arreglos indexados por pagina: la pagina
+    // densa hace de clave, sin tabla hash.
+    static long long lru(const vector<int> &traza, int paginas, int marcos) {
+        vector<int> ant(paginas, -1), sig(paginas, -1);
+        vector<char> presente(paginas, 0);
+        int cabeza = -1, cola = -1, usados = 0;   // cabeza: mas reciente
+        long long f = 0;
+        auto quitar = [&](int p) {
+            if (ant[p] != -1) sig[ant[p]] = sig[p]; else cabeza = sig[p];
+            if (sig[p] != -1) ant[sig[p]] = ant[p]; else cola = ant[p];
+        };
+        auto alFrente = [&](int p) {
+            ant[p] = -1; sig[p] = cabeza;
+            if (cabeza != -1) ant[cabeza] = p; else cola = p;
+            cabeza = p;
+        };
+        for (int p : traza) {
+            if (presente[p]) {
+                if (cabeza != p) { quitar(p); alFrente(p); }
+                continue;
+            }
+            f++;
+            if (usados < marcos) usados++;
+            else { int v = cola; quitar(v); presente[v] = 0; }
+            alFrente(p);
+            presente[p] = 1;
+        }
+        return f;
+    }
+
+    static long long reloj(const vector<int> &traza, int paginas, int marcos) {
+        vector<int> marco(paginas, -1), pagina(marcos, -1);
+        vector<char> ref(marcos, 0);
+        int usados = 0, mano = 0;
+        long long f = 0;
+        for (int p : traza) {
+            if (marco[p] != -1) { ref[marco[p]] = 1; continue; }
+            f++;
+            int m;
+            if (usados < marcos) m = usados++;
+            else {
+                while (ref[mano]) { ref[mano] = 0; mano = mano + 1 == marcos ? 0 : mano + 1; }
+                m = mano;
+                marco[pagina[m]] = -1;
+                mano = mano + 1 == marcos ? 0 : mano + 1;
+            }
+            pagina[m] = p;
+            marco[p] = m;
+            ref[m] = 1;
+        }
+        return f;
+    }
+
+    // Belady: se precalcula el proximo uso de cada referencia recorriendo la traza
+    // al reves; las paginas residentes estan en un heap por proximo uso con
+    // borrado perezoso, que se reconstruye cuando las entradas viejas se acumulan.
+    static long long optimo(const vector<int> &traza, int paginas, int marcos) {
+        int n = traza.size();
+        vector<int> proximo(n), ultimo(paginas, INT_MAX);
+        for (int i = n - 1; i >= 0; --i) { proximo[i] = ultimo[traza[i]]; ultimo[traza[i]] = i; }
+        vector<int> clave(paginas, -1);   // proximo uso vigente; -1 si no residente
+        vector<pair<int,int>> heap;
+        int usados = 0;
+        long long f = 0;
+        for (int i = 0; i < n; ++i) {
+            int p = traza[i];
+            if (clave[p] == -1) {
+                f++;
+                if (usados < marcos) usados++;
+                else {
+                    while (clave[heap.front().second] != heap.front().first) {
+                        pop_heap(heap.begin(), heap.end());
+                        heap.pop_back();
+                    }
+                    clave[heap.front().second] = -1;
+                    pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+            }
+            clave[p] = proximo[i];
+            heap.push_back({proximo[i], p});
+            push_heap(heap.begin(), heap.end());
+            if ((int)heap.size() > 4 * marcos + 64) {   // cada pagina tiene una sola entrada vigente
+                heap.erase(remove_if(heap.begin(), heap.end(), [&](const pair<int,int> &e) {
+                    return clave[e.second] != e.first;
+                }), heap.end());
+                make_heap(heap.begin(), heap.end());
+            }
+        }
+        return f;
+    }
+};
+
+// TLB asociativo por conjuntos: entradas = conjuntos * vias, con conjuntos
+// potencia de dos para elegir el conjunto con una mascara. Cada conjunto ocupa
+// vias posiciones contiguas de etiquetas y edades.
+struct TLB {
+    enum Politica { LRU, FIFO, ALEATORIA };
+    int conjuntos = 16, vias = 4, bits = 4;
+    Politica politica = LRU;
+    double t_tlb = 1, t_memoria = 100;   // para el tiempo efectivo de acceso
+
+    static TLB leer(const json &j) {
+        TLB T;
+        int entradas = j.value("entradas", 64);
+        T.vias = max(1, j.value("asociatividad", 4));
+        if (entradas < T.vias || entradas % T.vias) throw runtime_error("TLB: entradas debe ser multiplo de asociatividad");
+        T.conjuntos = entradas / T.vias;
+        if (T.conjuntos & (T.conjuntos - 1)) throw runtime_error("TLB: el numero de conjuntos debe ser potencia de dos");
+        T.bits = __builtin_ctz(T.conjuntos);
+        string p = j.value("politica", "LRU");
+        if (p == "LRU") T.politica = LRU;
+        else if (p == "FIFO") T.politica = FIFO;
+        else if (p == "aleatoria") T.politica = ALEATORIA;
+        else throw runtime_error("Politica de TLB desconocida: " + p);
+        T.t_tlb = j.value("t_tlb", 1.0);
+        T.t_memoria = j.value("t_memoria", 100.0);
+        return T;
+    }
+
+    // Aciertos sobre una traza de paginas densas (la pagina incluye al proceso).
+    long long aciertos(const vector<int> &traza) const {
+        int total = conjuntos * vias;
+        vector<uint32_t> etiqueta(total, 0);   // etiqueta + 1; 0 = vacia
+        vector<uint64_t> edad(total, 0);       // LRU: ultimo uso; FIFO: carga (64 bits: no da la vuelta)
+        uint64_t reloj = 0;
+        uint32_t mascara = conjuntos - 1;
+        uint64_t azar = 0x2545F4914F6CDD1DULL;
+        long long h = 0;
+        for (int p : traza) {
+            uint32_t *et = &etiqueta[(p & mascara) * vias];
+            uint64_t *ed = &edad[(p & mascara) * vias];
+            uint32_t tag = ((uint32_t)p >> bits) + 1;
+            ++reloj;
+            int w = 0;
+            while (w < vias && et[w] != tag) ++w;
+            if (w < vias) {
+                h++;
+                if (politica == LRU) ed[w] = reloj;
+                continue;
+            }
+            int v = 0;
+            if (politica == ALEATORIA) {
+                azar ^= azar << 13; azar ^= azar >> 7; azar ^= azar << 17;
+                v = (int)(azar % vias);
+                for (int k = 0; k < vias; ++k) if (et[k] == 0) { v = k; break; }
+            } else {
+                for (int k = 1; k < vias; ++k) if (ed[k] < ed[v]) v = k;   // vacias tienen edad 0
+            }
+            et[v] = tag;
+            ed[v] = reloj;
+        }
+        return h;
+    }
+};
+
+// Dispositivo de E/S con su propia cola: FCFS o ascensor (SCAN por pista).
+struct Dispositivo {
+    string nombre = "disp";
+    bool ascensor = false;
+    double costo_pista = 0;   // tiempo extra por pista recorrida (ascensor)
+    deque<int> fifo;
+    multimap<int, int> por_pista;   // (pista, indice del proceso)
+    int cabeza = 0;
+    bool subiendo = true;
+    long long ocupado = 0, atendidas = 0, espera_cola = 0;
+
+    void reiniciar() {
+        fifo.clear(); por_pista.clear();
+        cabeza = 0; subiendo = true;
+        ocupado = atendidas = espera_cola = 0;
+    }
+    bool vacia() const { return ascensor ? por_pista.empty() : fifo.empty(); }
+    void agregar(int i, int pista) {
+        if (ascensor) por_pista.emplace(pista, i); else fifo.push_back(i);
+    }
+    // Saca el siguiente pedido; en ascensor sigue la direccion actual y la
+    // invierte al llegar al extremo.
+    pair<int,int> siguiente() {
+        if (!ascensor) { int i = fifo.front(); fifo.pop_front(); return {i, 0}; }
+        auto it = por_pista.end();
+        if (subiendo) {
+            it = por_pista.lower_bound(cabeza);
+            if (it == por_pista.end()) { subiendo = false; it = prev(por_pista.end()); }
+        } else {
+            it = por_pista.upper_bound(cabeza);
+            if (it == por_pista.begin()) { subiendo = true; it = por_pista.begin(); }
+            else it = prev(it);
+        }
+        int recorrido = abs(it->first - cabeza), i = it->second;
+        cabeza = it->first;
+        por_pista.erase(it);
+        return {i, (int)round(recorrido * costo_pista)};
+    }
+};
+
+// Salida con buffer propio: enteros con to_chars y relleno a mano, volcados a
+// la salida en bloques de 1 MB. Reemplaza a setw en las tablas de muchas filas.
+class Escritor {
+    ostream &os;
+    string buf;
+    static constexpr size_t LIMITE = 1 << 20;
+    void revisar() { if (buf.size() >= LIMITE) volcar(); }
+public:
+    explicit Escritor(ostream &o) : os(o) { buf.reserve(LIMITE + 4096); }
+    ~Escritor() { volcar(); }
+
+    Escritor &texto(string_view s) { buf.append(s); revisar(); return *this; }
+    Escritor &entero(long long x, int ancho = 0) {   // alineado a la derecha en ancho
+        char num[24];
+        char *fin = to_chars(num, num + sizeof num, x).ptr;
+        if (fin - num < ancho) buf.append(ancho - (fin - num), ' ');
+        buf.append(num, fin);
+        revisar();
+        return *this;
+    }
+    Escritor &real(double x, int decimales = 2) {   // null si no es finito (JSON)
+        if (!isfinite(x)) return texto("null");
+        char num[64];
+        int n = snprintf(num, sizeof num, "%.*f", decimales, x);
+        buf.append(num, n);
+        revisar();
+        return *this;
+    }
+    void volcar() {
+        os.write(buf.data(), buf.size());
+        buf.clear();
+    }
+};
+
+enum class Formato { TABLA, JSON, CSV };
+
+// Histograma log-lineal (estilo HDR): valores menores a SUB exactos y, desde
+// ahi, SUB cubetas por potencia de 2, con error relativo menor a 1/SUB. Tamano
+// fijo, para percentiles de muchas muestras sin guardarlas.
+struct Histograma {
+    static constexpr int SUB = 32, BITS = 5;
+    vector<long long> c = vector<long long>(SUB * 60, 0);
+    long long n = 0, maximo = 0;
+
+    static int cubeta(long long v) {
+        if (v < SUB) return (int)v;
+        int corrimiento = 63 - __builtin_clzll(v) - BITS;
+        return SUB + corrimiento * SUB + (int)((v >> corrimiento) - SUB);
+    }
+    static long long inferior(int k) {   // menor valor de la cubeta
+        if (k < SUB) return k;
+        return (long long)(SUB + (k - SUB) % SUB) << ((k - SUB) / SUB);
+    }
+    static long long valor(int k) {   // punto medio de la cubeta
+        if (k < SUB) return k;
+        return inferior(k) + ((1LL << ((k - SUB) / SUB)) >> 1);
+    }
+    void agregar(long long v) {
+        v = max(0LL, v);
+        c[cubeta(v)]++;
+        n++;
+        maximo = max(maximo, v);
+    }
+    long long percentil(double q) const {
+        long long rango = max(1LL, (long long)ceil(q * n)), acum = 0;
+        for (size_t k = 0; k < c.size(); ++k)
+            if ((acum += c[k]) >= rango) return min(valor(k), maximo);
+        return maximo;
+    }
+};
+
+// Percentiles exactos por rango mas cercano con nth_element; los cuantiles van
+// en orden creciente y cada uno solo parte el tramo a la derecha del anterior.
+// Desordena v.
+vector<int> percentiles(vector<int> &v, const vector<double> &qs) {
+    vector<int> r;
+    auto desde = v.begin();
+    for (double q : qs) {
+        auto k = v.begin() + max<long long>(0, (long long)ceil(q * v.size()) - 1);
+        nth_element(desde, k, v.end());
+        r.push_back(*k);
+        desde = k;
+    }
+    return r;
+}
+
+// Estadisticas de los procesos a medida que terminan (--resumen): sumas para
+// los promedios y un histograma por metrica para los percentiles.
+struct EnLinea {
+    long long n = 0;
+    int max_fin = 0;
+    double suma_resp = 0, suma_esp = 0, suma_ret = 0;
+    Histograma resp, esp, ret;
+
+    void agregar(const Process &p) {
+        n++;
+        max_fin = max(max_fin, p.fin);
+        suma_resp += p.respuesta();
+        suma_esp += p.espera();
+        suma_ret += p.retorno();
+        resp.agregar(p.respuesta());
+        esp.agregar(p.espera());
+        ret.agregar(p.retorno());
+    }
+};
+
+// Diagrama de Gantt: cada despacho (pid, inicio, duracion) se agrega a un
+// bloque en memoria; los bloques llenos pasan a un hilo escritor, asi la
+// simulacion no espera al disco. Un archivo .json sale en formato Chrome trace
+// (1 unidad simulada = 1 us, un hilo por proceso); cualquier otro es binario:
+// la cabecera "SOGANTT1" y registros de tres int32 nativos.
+class TrazaGantt {
+public:
+    struct Tramo { int32_t pid, inicio, dur; };
+
+    explicit TrazaGantt(const string &archivo)
+        : chrome(archivo.size() >= 5 && archivo.compare(archivo.size() - 5, 5, ".json") == 0),
+          f(archivo, ios::binary) {
+        if (!f) throw runtime_error("No se pudo crear " + archivo);
+        if (chrome) f << "{\"traceEvents\":[";
+        else f.write("SOGANTT1", 8);
+        bloque.reserve(BLOQUE);
+        hilo = thread(&TrazaGantt::escribir, this);
+    }
+    ~TrazaGantt() { cerrar(); }
+
+    void agregar(int pid, int inicio, int dur) {
+        bloque.push_back({pid, inicio, dur});
+        if (bloque.size() == BLOQUE) entregar();
+    }
+
+    // Escribe lo pendiente y cierra el archivo; despues ya no se puede agregar.
+    void cerrar() {
+        if (!hilo.joinable()) return;
+        entregar();
+        {
+            lock_guard<mutex> l(m);
+            fin = true;
+        }
+        cv.notify_one();
+        hilo.join();
+        if (chrome) f << "]}\n";
+        f.close();
+    }
+
+    long long tramos() const { return total; }
+
+private:
+    static constexpr size_t BLOQUE = 1 << 16;
+    bool chrome;
+    ofstream f;
+    vector<Tramo> bloque;
+    long long total = 0;
+    deque<vector<Tramo>> cola;
+    mutex m;
+    condition_variable cv;
+    bool fin = false;
+    thread hilo;
+
+    void entregar() {
+        if (bloque.empty()) return;
+        total += bloque.size();
+        {
+            lock_guard<mutex> l(m);
+            cola.push_back(move(bloque));
+        }
+        cv.notify_one();
+        bloque = {};
+        bloque.reserve(BLOQUE);
+    }
+
+    void escribir() {
+        bool primero = true;
+        string texto;
+        while (true) {
+            vector<Tramo> v;
+            {
+                unique_lock<mutex> l(m);
+                cv.wait(l, [&] { return fin || !cola.empty(); });
+                if (cola.empty()) return;
+                v = move(cola.front());
+                cola.pop_front();
+            }
+            if (!chrome) {
+                f.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(Tramo));
+                continue;
+            }
+            texto.clear();
+            char num[16];
+            auto entero = [&](int x) { texto.append(num, to_chars(num, num + sizeof num, x).ptr); };
+            for (auto &tr : v) {
+                texto += primero ? "\n" : ",\n";
+                primero = false;
+                texto += "{\"name\":\"P";
+                entero(tr.pid);
+                texto += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+                entero(tr.pid);
+                texto += ",\"ts\":";
+                entero(tr.inicio);
+                texto += ",\"dur\":";
+                entero(tr.dur);
+                texto += "}";
+            }
+            f.write(texto.data(), texto.size());
+        }
+    }
+};
+
+// Instrumentacion: compilando con -DSIM_PERFIL cada Simulator cuenta el trabajo
+// de los caminos calientes y mide el tiempo de cada fase, y run() lo imprime al
+// final. Sin la macro los PERFIL_* no generan codigo.
+#ifdef SIM_PERFIL
+struct Perfil {
+    enum Fase { CARGA, MEMORIA, PLANIFICADOR, REEMPLAZO, IMPRESION, N_FASES };
+    long long bloques_revisados = 0, asignaciones = 0, divisiones = 0, fusiones = 0;
+    long long encolados = 0, despachos = 0, ordenamientos = 0, eventos = 0;
+    double ms[N_FASES] = {};
+};
+
+struct FasePerfil {   // suma a ms el tiempo hasta el fin del bloque
+    double &ms;
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    explicit FasePerfil(double &m) : ms(m) {}
+    ~FasePerfil() { ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count(); }
+};
+#define PERFIL_CONTAR(campo, n) (perfil.campo += (n))
+#define PERFIL_FASE(fase) FasePerfil fase_perfil(perfil.ms[Perfil::fase])
+#else
+#define PERFIL_CONTAR(campo, n) ((void)0)
+#define PERFIL_FASE(fase) ((void)0)
+#endif
+
 class Simulator {
 public:
+#ifdef SIM_PERFIL
+    Perfil perfil;
+#endif
     vector<Process> procesos;
     vector<MemReq> solicitudes_mem;
     vector<Block> memoria;
@@ -58,33 +853,144 @@ public:
     int quantum = 4;
     int memoria_size = 1048576;
     int last_pos = 0; // Para next-fit
+    ModoMem modo_mem = ModoMem::INICIAL;
+    long long mem_asignadas = 0, mem_fallidas = 0, mem_liberaciones = 0;
+    bool admision = false;   // el proceso no entra a listos hasta tener su memoria
+    Compactacion compactacion = Compactacion::NO;
+    double costo_byte = 0;   // tiempo simulado por byte movido al compactar
+    double deuda_compactacion = 0;   // costo aun no cargado al reloj
+    long long compactaciones = 0, bytes_movidos = 0, tiempo_compactacion = 0;
+
+    // Intercambio (planificador de mediano plazo): si un proceso no puede ser
+    // admitido se suspende a otro residente, se liberan sus bloques y se lo
+    // vuelve a cargar cuando haya memoria. Ambos traslados cuestan por byte.
+    Victima victima = Victima::NINGUNA;
+    double costo_intercambio = 0;
+    double deuda_intercambio = 0;
+    long long suspensiones = 0, reanudaciones = 0, bytes_intercambiados = 0, tiempo_intercambio = 0;
+    vector<int> residentes, pos_residente;   // procesos admitidos con memoria
+    deque<int> suspendidos;
+    long long fallidas_frag = 0;   // fallas con libre suficiente pero sin hueco contiguo
+
+    // Serie de fragmentacion (--fragmentacion): una muestra cada serie_cada
+    // eventos de asignacion o liberacion; el anillo conserva las ultimas.
+    struct MuestraMem {
+        long long evento;
+        int t;
+        double externa;   // 1 - mayor hueco / libre total
+        int mayor, huecos;
+        double uso;
+    };
+    int serie_cada = 0;   // 0: sin serie
+    bool sin_muestreo = false;   // durante un intento de admision que puede deshacerse
+    long long revisados = 0;  // bloques que miro el ultimo alloc_*
+
+    // Costo de cada llamada a alloc_* (--costo-asignacion), por estrategia.
+    struct CostoAsignacion { Histograma bloques, ns; };
+    vector<CostoAsignacion> costo_asignacion;   // vacio: no se mide
+    long long eventos_mem = 0;
+    Anillo<MuestraMem> serie_frag;
+
+    // Paginacion: con tam_pagina > 0 cada solicitud se reparte en paginas cuyos
+    // marcos salen de una lista libre. Las tablas de paginas de todos los procesos
+    // viven en un solo arreglo: el proceso i usa tabla_paginas[tp_ini[i] ...].
+    int tam_pagina = 0;
+    vector<int> marcos_libres;
+    vector<int> tabla_paginas, tp_ini, tp_usadas;
+    long long frag_interna = 0, bytes_paginados = 0;
+
+    // Memoria virtual: los procesos con "referencias" las van emitiendo a medida
+    // que ejecutan, y la traza global resultante se evalua con cada algoritmo de
+    // reemplazo sobre "marcos" marcos.
+    Cow<int> referencias;   // cadenas de todos los procesos, una tras otra
+    bool memoria_virtual = false;
+    int marcos_virtuales = 0;
+    vector<Reemplazo::Alg> algs_reemplazo;
+    vector<int> traza, base_pagina;
+    struct ResultadoReemplazo { Reemplazo::Alg alg; long long fallos; double ms; };
+    vector<ResultadoReemplazo> resultados_reemplazo;
+    bool con_tlb = false;      // "tlb": se simula sobre la misma traza
+    TLB tlb;
+    long long tlb_aciertos = 0;
+    double tlb_ms = 0;
+
+    // Rafagas de CPU y E/S: pool compartido por todos los procesos. Cada fin de
+    // E/S es un evento (tiempo, dispositivo) en un heap.
+    Cow<Rafaga> rafagas;
+    vector<Dispositivo> dispositivos;
+    json config_dispositivos;
+    priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> fin_io;
+    vector<int> atendiendo;   // proceso en servicio en cada dispositivo (-1 libre)
+    vector<int> pedido_io;    // instante del pedido de E/S de cada proceso
+    long long cpu_ocupada = 0;
+
+    Formato formato = Formato::TABLA;   // --output
+    // --resumen: sin tablas, estadisticas en linea. La memoria solo queda acotada
+    // con "generador" (ver flujoPosible); una carga leida del JSON ya esta completa.
+    bool solo_resumen = false;
+    bool sin_tiempos = false;           // --regresion: sin tiempos de reloj, la salida se repite
+    EnLinea en_linea;
+    shared_ptr<TrazaGantt> gantt;     // --gantt: despachos al archivo (solo en run)
+    string archivo_gantt;
+    bool paralelo = false;            // --paralelo: memoria y CPU en hilos distintos si no se acoplan
+    bool con_generador = false;       // la carga viene de "generador" y puede regenerarse
+    Generador generador;
+    bool usar_cache = false;          // --cache: reutiliza la carga previa del mismo archivo
+    bool procesos_ordenados = false;  // la carga ya dejo procesos ordenados por llegada
+    bool en_flujo = false;            // --resumen con generador: la carga se genera durante la simulacion
 
     void loadConfig(const string &fname) {
-        ifstream f(fname);
+        PERFIL_FASE(CARGA);
+        ifstream f(fname, ios::binary);
         if(!f) throw runtime_error("No se pudo abrir " + fname);
-        json j; f >> j;
+        string texto((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+        uint64_t hash = hashTexto(texto);
+        int64_t mtime = mtimeArchivo(fname);
+        string fcache = fname + ".cache";
+        bool flujo_pedido = en_flujo;   // solo aplica a cargas generadas
+        en_flujo = false;
+        if (usar_cache && cargarCache(fcache, hash, mtime)) return;
 
-        string a = j["cpu"]["algoritmo"].get<string>();
-        if (a == "FCFS") alg_cpu = AlgCPU::FCFS;
-        else if (a == "SPN" || a == "SJF") alg_cpu = AlgCPU::SPN;
-        else if (a == "RR") alg_cpu = AlgCPU::RR;
-        if (j["cpu"].contains("quantum")) quantum = j["cpu"]["quantum"].get<int>();
+        json j = json::parse(texto);
+        aplicarConfig(j);
+
+        if (j.contains("generador")) {   // no se guarda en cache: regenerar es mas rapido
+            generador = Generador::leer(j["generador"]);
+            con_generador = true;
+            if (flujo_pedido && flujoPosible()) {   // nada que generar por adelantado
+                en_flujo = true;
+                prepararDispositivos();
+                procesos.clear();
+                procesos_ordenados = true;
+                return;
+            }
+            generarCarga();
+            return;
+        }
 
         procesos.clear();
+        referencias.mut().clear();
+        rafagas.mut().clear();
         for (auto &p : j["procesos"]) {
             Process pr;
             pr.pid = p["pid"].get<int>();
             pr.llegada = p["llegada"].get<int>();
             pr.servicio = p["servicio"].get<int>();
             pr.restante = pr.servicio;
+            pr.prioridad = p.value("prioridad", 0);
+            pr.particion = p.value("particion", 0);
+            if (p.contains("rafagas")) leerRafagas(pr, p["rafagas"]);
+            if (p.contains("referencias")) {
+                pr.ref_ini = referencias.size();
+                for (auto &r : p["referencias"]) {
+                    int pag = r.get<int>();
+                    if (pag < 0) throw runtime_error("Referencia a pagina negativa (pid " + to_string(pr.pid) + ")");
+                    referencias.mut().push_back(pag);
+                }
+                pr.ref_n = referencias.size() - pr.ref_ini;
+            }
             procesos.push_back(pr);
         }
-        memoria_size = j["memoria"]["tam"].get<int>();
-        string me = j["memoria"]["estrategia"].get<string>();
-        if (me == "first-fit") alg_mem = AlgMem::FIRST_FIT;
-        else if (me == "best-fit") alg_mem = AlgMem::BEST_FIT;
-        else if (me == "worst-fit") alg_mem = AlgMem::WORST_FIT;
-        else alg_mem = AlgMem::NEXT_FIT;
 
         solicitudes_mem.clear();
         if (j.contains("solicitudes_mem")) {
@@ -92,27 +998,283 @@ public:
                 MemReq mr;
                 mr.pid = m["pid"].get<int>();
                 mr.tam = m["tam"].get<int>();
+                mr.tiempo = m.value("tiempo", -1);
                 solicitudes_mem.push_back(mr);
             }
         }
+        if (admision) omitirImposibles();
+        ordenar_procesos();
+        prepararDispositivos();
+        if (usar_cache) guardarCache(fcache, hash, mtime, j);
+    }
+
+    // "rafagas": [cpu, io, cpu, ...]; las de E/S pueden ser numeros (dispositivo 0)
+    // o {"io": dur, "disp": d, "pista": p}. El servicio es la suma de las de CPU.
+    void leerRafagas(Process &pr, const json &rs) {
+        if (rs.size() % 2 == 0) throw runtime_error("rafagas debe empezar y terminar en CPU (pid " + to_string(pr.pid) + ")");
+        pr.raf_ini = rafagas.size();
+        pr.servicio = 0;
+        for (size_t k = 0; k < rs.size(); ++k) {
+            Rafaga r{0};
+            if (rs[k].is_object()) {
+                r.dur = rs[k].value("io", 0);
+                r.disp = rs[k].value("disp", 0);
+                r.pista = rs[k].value("pista", 0);
+            } else r.dur = rs[k].get<int>();
+            if (r.dur < 0 || r.disp < 0 || r.pista < 0)
+                throw runtime_error("Rafaga con duracion, disp o pista negativos (pid " + to_string(pr.pid) + ")");
+            // el proceso termina al agotar su servicio: una de CPU vacia saltearia la E/S pendiente
+            if (k % 2 == 0 && r.dur == 0)
+                throw runtime_error("Rafaga de CPU de duracion 0 (pid " + to_string(pr.pid) + ")");
+            if (k % 2 == 0) pr.servicio += r.dur;
+            rafagas.mut().push_back(r);
+        }
+        pr.raf_n = rs.size();
+        pr.restante = pr.servicio;
+    }
+
+    // Los dispositivos se crean segun "dispositivos" o, si faltan, uno FCFS por
+    // cada numero de dispositivo usado en las rafagas.
+    void prepararDispositivos() {
+        int usados = 0;
+        for (size_t k = 1; k < rafagas.size(); ++k) usados = max(usados, rafagas[k].disp + 1);
+        dispositivos.clear();
+        for (auto &d : config_dispositivos) {
+            Dispositivo x;
+            x.nombre = d.value("nombre", "disp" + to_string(dispositivos.size()));
+            string pol = d.value("politica", "FCFS");
+            if (pol == "ascensor" || pol == "SCAN") x.ascensor = true;
+            else if (pol != "FCFS") throw runtime_error("Politica de dispositivo desconocida: " + pol);
+            x.costo_pista = d.value("costo_pista", 0.0);
+            dispositivos.push_back(x);
+        }
+        while ((int)dispositivos.size() < usados) {
+            Dispositivo x;
+            x.nombre = "disp" + to_string(dispositivos.size());
+            dispositivos.push_back(x);
+        }
+    }
+
+    // Parametros escalares del archivo (todo menos los arreglos de la carga).
+    void aplicarConfig(const json &j) {
+        string a = j["cpu"]["algoritmo"].get<string>();
+        if (a == "FCFS") alg_cpu = AlgCPU::FCFS;
+        else if (a == "SPN" || a == "SJF") alg_cpu = AlgCPU::SPN;
+        else if (a == "RR") alg_cpu = AlgCPU::RR;
+        if (j["cpu"].contains("quantum")) quantum = j["cpu"]["quantum"].get<int>();
+
+        memoria_size = j["memoria"]["tam"].get<int>();
+        string me = j["memoria"]["estrategia"].get<string>();
+        if (me == "first-fit") alg_mem = AlgMem::FIRST_FIT;
+        else if (me == "best-fit") alg_mem = AlgMem::BEST_FIT;
+        else if (me == "worst-fit") alg_mem = AlgMem::WORST_FIT;
+        else alg_mem = AlgMem::NEXT_FIT;
+        string modo = j["memoria"].value("modo", "inicial");
+        if (modo == "temporal") modo_mem = ModoMem::TEMPORAL;
+        else if (modo == "inicial") modo_mem = ModoMem::INICIAL;
+        else throw runtime_error("Modo de memoria desconocido: " + modo);
+        admision = j["memoria"].value("admision", false);
+        if (admision) modo_mem = ModoMem::TEMPORAL;
+        string comp = j["memoria"].value("compactacion", "no");
+        if (comp == "no") compactacion = Compactacion::NO;
+        else if (comp == "total") compactacion = Compactacion::TOTAL;
+        else if (comp == "incremental") compactacion = Compactacion::INCREMENTAL;
+        else throw runtime_error("Compactacion desconocida: " + comp);
+        costo_byte = j["memoria"].value("costo_byte", 0.0);
+        victima = Victima::NINGUNA;
+        if (j["memoria"].contains("intercambio")) {
+            auto &x = j["memoria"]["intercambio"];
+            string v = x.value("politica", "mayor");
+            if (v == "mayor") victima = Victima::MAYOR;
+            else if (v == "prioridad") victima = Victima::PRIORIDAD;
+            else if (v == "espera") victima = Victima::ESPERA;
+            else throw runtime_error("Politica de intercambio desconocida: " + v);
+            costo_intercambio = x.value("costo_byte", 0.0);
+            admision = true;
+            modo_mem = ModoMem::TEMPORAL;
+        }
+        tam_pagina = j["memoria"].value("tam_pagina", 0);
+        if (tam_pagina < 0) throw runtime_error("tam_pagina invalido");
+
+        config_dispositivos = j.value("dispositivos", json::array());
+
+        memoria_virtual = j.contains("memoria_virtual") || j.contains("tlb");
+        con_tlb = j.contains("tlb");
+        if (con_tlb) tlb = TLB::leer(j["tlb"]);
+        algs_reemplazo.clear();
+        if (j.contains("memoria_virtual")) {
+            auto &v = j["memoria_virtual"];
+            marcos_virtuales = v.value("marcos", tam_pagina > 0 ? memoria_size / tam_pagina : 64);
+            if (v.contains("algoritmos"))
+                for (auto &a : v["algoritmos"]) algs_reemplazo.push_back(Reemplazo::leer(a.get<string>()));
+            else algs_reemplazo = {Reemplazo::FIFO, Reemplazo::LRU, Reemplazo::CLOCK, Reemplazo::OPT};
+        }
 
         memoria.clear();
         memoria.push_back(Block{0,0,memoria_size,true,-1});
+        last_pos = 0;
+    }
+
+    // La carga puede generarse por bloques mientras corre la linea de tiempo si
+    // nada necesita la lista completa: sin E/S, referencias, particiones ni
+    // admision, y en modo inicial solo si la memoria no influye en la CPU.
+    bool flujoPosible() const {
+        return generador.rafagas_io == 0 && !generador.con_refs && generador.particiones == 1
+            && !admision && !memoria_virtual && tam_pagina == 0 && !paralelo
+            && (modo_mem == ModoMem::TEMPORAL || memoriaIndependiente());
+    }
+
+    // Con control de admision un proceso cuyas solicitudes al llegar no entran
+    // ni en la memoria vacia quedaria bloqueado para siempre: se avisa y se
+    // omiten sus solicitudes, asi corre sin memoria propia.
+    void omitirImposibles() {
+        long long capacidad = tam_pagina > 0 ? memoria_size / tam_pagina : memoria_size;
+        map<int, long long> total;
+        for (auto &r : solicitudes_mem)
+            if (r.tiempo < 0) total[r.pid] += tam_pagina > 0 ? paginasDe(r.tam) : r.tam;
+        set<int> omitidos;
+        for (auto &[pid, t] : total) {
+            if (t <= capacidad) continue;
+            cerr << "Aviso: las solicitudes del pid " << pid << " no entran en la memoria ("
+                 << memoria_size << " bytes); se omiten\n";
+            omitidos.insert(pid);
+        }
+        if (omitidos.empty()) return;
+        auto &v = solicitudes_mem;
+        v.erase(remove_if(v.begin(), v.end(), [&](const MemReq &r) {
+            return r.tiempo < 0 && omitidos.count(r.pid);
+        }), v.end());
+    }
+
+    void generarCarga() {
+        generador.generar(procesos, solicitudes_mem, referencias.mut(), rafagas.mut(), memoria_size);
+        prepararDispositivos();
+        procesos_ordenados = true;    // se genera en orden de llegada y pid
+    }
+
+    void ordenar_procesos() {
+        PERFIL_CONTAR(ordenamientos, 1);
+        sort(procesos.begin(), procesos.end(), [](const Process &a, const Process &b) {
+            if (a.llegada != b.llegada) return a.llegada < b.llegada;
+            return a.pid < b.pid;
+        });
+        procesos_ordenados = true;
+    }
+
+    // Cache de carga: <config>.cache guarda la imagen binaria de procesos (ya
+    // ordenados) y solicitudes_mem, junto con el resto del JSON. Se invalida si
+    // cambia el hash del contenido o la fecha de modificacion del archivo.
+    struct CabeceraCache {
+        char magia[8];
+        uint32_t version, tam_process, tam_memreq, reservado;
+        uint64_t hash;
+        int64_t mtime;
+        uint64_t tam_resto, n_procesos, n_solicitudes, n_referencias, n_rafagas;
+    };
+    static constexpr char MAGIA_CACHE[8] = {'S','O','C','A','C','H','E','1'};
+    static constexpr uint32_t VERSION_CACHE = 6;
+
+    static uint64_t hashTexto(const string &s) {   // FNV-1a 64 bits
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) { h ^= c; h *= 1099511628211ULL; }
+        return h;
+    }
+
+    static int64_t mtimeArchivo(const string &fname) {
+        error_code ec;
+        auto t = filesystem::last_write_time(fname, ec);
+        return ec ? 0 : (int64_t)t.time_since_epoch().count();
+    }
+
+    template <class T>
+    static bool leerArreglo(ifstream &f, vector<T> &v, uint64_t n) {
+        static_assert(is_trivially_copyable<T>::value, "imagen binaria");
+        v.resize(n);
+        f.read(reinterpret_cast<char*>(v.data()), n * sizeof(T));
+        return (bool)f;
+    }
+
+    bool cargarCache(const string &fcache, uint64_t hash, int64_t mtime) {
+        ifstream f(fcache, ios::binary);
+        if (!f) return false;
+        CabeceraCache c;
+        if (!f.read(reinterpret_cast<char*>(&c), sizeof(c))) return false;
+        if (memcmp(c.magia, MAGIA_CACHE, 8) != 0 || c.version != VERSION_CACHE ||
+            c.tam_process != sizeof(Process) || c.tam_memreq != sizeof(MemReq) ||
+            c.hash != hash || c.mtime != mtime) return false;
+        string resto(c.tam_resto, '\0');
+        if (!f.read(&resto[0], c.tam_resto)) return false;
+        vector<Process> ps;
+        vector<MemReq> ms;
+        vector<int> rs;
+        vector<Rafaga> fs;
+        if (!leerArreglo(f, ps, c.n_procesos) || !leerArreglo(f, ms, c.n_solicitudes) ||
+            !leerArreglo(f, rs, c.n_referencias) || !leerArreglo(f, fs, c.n_rafagas)) return false;
+
+        aplicarConfig(json::parse(resto));
+        procesos.swap(ps);
+        solicitudes_mem.swap(ms);
+        referencias.mut().swap(rs);
+        rafagas.mut().swap(fs);
+        prepararDispositivos();
+        procesos_ordenados = true;
+        return true;
+    }
+
+    void guardarCache(const string &fcache, uint64_t hash, int64_t mtime, const json &j) const {
+        json r = j;
+        r.erase("procesos");
+        r.erase("solicitudes_mem");
+        string resto = r.dump();
+        CabeceraCache c{};
+        memcpy(c.magia, MAGIA_CACHE, 8);
+        c.version = VERSION_CACHE;
+        c.tam_process = sizeof(Process);
+        c.tam_memreq = sizeof(MemReq);
+        c.hash = hash;
+        c.mtime = mtime;
+        c.tam_resto = resto.size();
+        c.n_procesos = procesos.size();
+        c.n_solicitudes = solicitudes_mem.size();
+        c.n_referencias = referencias.size();
+        c.n_rafagas = rafagas.size();
+
+        // Se escribe a un temporal y se renombra para no dejar imagenes a medias.
+        string tmp = fcache + ".tmp";
+        {
+            ofstream f(tmp, ios::binary | ios::trunc);
+            if (!f) return;
+            f.write(reinterpret_cast<const char*>(&c), sizeof(c));
+            f.write(resto.data(), resto.size());
+            f.write(reinterpret_cast<const char*>(procesos.data()), procesos.size() * sizeof(Process));
+            f.write(reinterpret_cast<const char*>(solicitudes_mem.data()), solicitudes_mem.size() * sizeof(MemReq));
+            f.write(reinterpret_cast<const char*>(referencias.data()), referencias.size() * sizeof(int));
+            f.write(reinterpret_cast<const char*>(rafagas.data()), rafagas.size() * sizeof(Rafaga));
+            if (!f) { f.close(); filesystem::remove(tmp); return; }
+        }
+        error_code ec;
+        filesystem::rename(tmp, fcache, ec);
+        if (ec) cerr << "Aviso: no se pudo escribir la cache " << fcache << "\n";
     }
 
     int alloc_first_fit(int pid, int tam) {
         for (auto &b : memoria) {
+            PERFIL_CONTAR(bloques_revisados, 1);
             if (b.libre && b.tam >= tam) {
+                revisados = &b - memoria.data() + 1;
                 return split_block(b, pid, tam);
             }
         }
+        revisados = memoria.size();
         return -1;
     }
 
     int alloc_best_fit(int pid, int tam) {
         int best_idx = -1, best_size = INT_MAX;
+        revisados = memoria.size();
         for (int i=0;i<(int)memoria.size();++i) {
             auto &b = memoria[i];
+            PERFIL_CONTAR(bloques_revisados, 1);
             if (b.libre && b.tam >= tam && b.tam < best_size) {
                 best_size = b.tam;
                 best_idx = i;
@@ -124,8 +1286,10 @@ public:
 
     int alloc_worst_fit(int pid, int tam) {
         int worst_idx = -1, worst_size = -1;
+        revisados = memoria.size();
         for (int i=0;i<(int)memoria.size();++i) {
             auto &b = memoria[i];
+            PERFIL_CONTAR(bloques_revisados, 1);
             if (b.libre && b.tam >= tam && b.tam > worst_size) {
                 worst_size = b.tam;
                 worst_idx = i;
@@ -140,26 +1304,31 @@ public:
         for (int k=0; k<n; k++) {
             int i = (last_pos + k) % n;
             auto &b = memoria[i];
+            PERFIL_CONTAR(bloques_revisados, 1);
             if (b.libre && b.tam >= tam) {
                 last_pos = i;
+                revisados = k + 1;
                 return split_block(b, pid, tam);
             }
         }
+        revisados = n;
         return -1;
     }
 
     int split_block(Block &b, int pid, int tam) {
         if (b.tam > tam) {
+            PERFIL_CONTAR(divisiones, 1);
             int newId = memoria.size();
             int remaining = b.tam - tam;
             int allocInicio = b.inicio;
+            int id = b.id; // insert invalida la referencia b
             b.tam = tam;
             b.libre = false;
             b.pid_asignado = pid;
             Block rem{newId, allocInicio + tam, remaining, true, -1};
-            memoria.insert(memoria.begin() + (b.id + 1), rem);
+            memoria.insert(memoria.begin() + (id + 1), rem);
             rebuildBlocks();
-            return b.id;
+            return id;
         } else {
             b.libre = false;
             b.pid_asignado = pid;
@@ -182,163 +1351,1667 @@ public:
         vector<Block> nb;
         for (auto &b : memoria) {
             if (!nb.empty() && nb.back().libre && b.libre) {
+                PERFIL_CONTAR(fusiones, 1);
                 nb.back().tam += b.tam;
             } else nb.push_back(b);
         }
         memoria.swap(nb);
         rebuildBlocks();
+        muestrearMemoria();
     }
 
-    void assign_memory_requests() {
-        for (auto &req : solicitudes_mem) {
-            int bid = -1;
-            if (alg_mem == AlgMem::FIRST_FIT) bid = alloc_first_fit(req.pid, req.tam);
-            else if (alg_mem == AlgMem::BEST_FIT) bid = alloc_best_fit(req.pid, req.tam);
-            else if (alg_mem == AlgMem::WORST_FIT) bid = alloc_worst_fit(req.pid, req.tam);
-            else bid = alloc_next_fit(req.pid, req.tam);
-            req.block_id = bid;
+    void muestrearMemoria() {
+        if (serie_cada == 0 || tam_pagina > 0 || sin_muestreo) return;
+        if (eventos_mem++ % serie_cada) return;
+        long long libre = 0;
+        int mayor = 0, huecos = 0;
+        for (auto &b : memoria) {
+            if (!b.libre) continue;
+            libre += b.tam;
+            mayor = max(mayor, b.tam);
+            huecos++;
         }
+        int t = modo_mem == ModoMem::INICIAL ? 0 : reloj;   // en modo inicial todo se asigna en 0
+        serie_frag.push({eventos_mem - 1, t, libre ? 1.0 - (double)mayor / libre : 0.0, mayor, huecos,
+                         1.0 - (double)libre / memoria_size});
     }
 
-    // Schedulers
-    void run() {
-        sort(procesos.begin(), procesos.end(), [](const Process &a, const Process &b) {
-            if (a.llegada != b.llegada) return a.llegada < b.llegada;
-            return a.pid < b.pid;
-        });
-        assign_memory_requests();
-        if (alg_cpu == AlgCPU::FCFS) run_fcfs();
-        else if (alg_cpu == AlgCPU::SPN) run_spn();
-        else run_rr();
-        print_results();
-        print_memory();
+    long long libreTotal() const {
+        if (tam_pagina > 0) return (long long)marcos_libres.size() * tam_pagina;
+        long long l = 0;
+        for (auto &b : memoria) if (b.libre) l += b.tam;
+        return l;
     }
 
-    void run_fcfs() {
-        int t = 0;
-        for (auto &p : procesos) {
-            if (t < p.llegada) t = p.llegada;
-            p.inicio = t;
-            p.fin = t + p.servicio;
-            t = p.fin;
+    // Desliza los bloques asignados hacia direcciones bajas para juntar el espacio
+    // libre. TOTAL compacta toda la memoria; INCREMENTAL solo la ventana de bloques
+    // contiguos que reune tam bytes libres moviendo la menor cantidad de bytes.
+    // Devuelve los bytes movidos; su costo se carga al reloj en planificar.
+    long long compactar(int tam) {
+        int n = memoria.size(), l = 0, r = n - 1;
+        if (compactacion == Compactacion::INCREMENTAL) {
+            long long libre = 0, ocupado = 0, mejor = LLONG_MAX;
+            for (int d = 0, i = 0; d < n; ++d) {
+                (memoria[d].libre ? libre : ocupado) += memoria[d].tam;
+                while (i < d && (!memoria[i].libre || libre - memoria[i].tam >= tam)) {
+                    (memoria[i].libre ? libre : ocupado) -= memoria[i].tam;
+                    i++;
+                }
+                if (libre >= tam && ocupado < mejor) { mejor = ocupado; l = i; r = d; }
+            }
+            if (mejor == LLONG_MAX) return 0;
         }
+        vector<Block> nb(memoria.begin(), memoria.begin() + l);
+        int pos = memoria[l].inicio, hueco = 0;
+        long long movidos = 0;
+        for (int k = l; k <= r; ++k) {
+            Block b = memoria[k];
+            if (b.libre) { hueco += b.tam; continue; }
+            if (b.inicio != pos) movidos += b.tam;
+            b.inicio = pos;
+            pos += b.tam;
+            nb.push_back(b);
+        }
+        if (hueco > 0) nb.push_back(Block{0, pos, hueco, true, -1});
+        for (int k = r + 1; k < n; ++k) {
+            if (memoria[k].libre && nb.back().libre) nb.back().tam += memoria[k].tam;
+            else nb.push_back(memoria[k]);
+        }
+        memoria.swap(nb);
+        rebuildBlocks();
+        last_pos = 0;
+        compactaciones++;
+        bytes_movidos += movidos;
+        if (costo_byte > 0) deuda_compactacion += movidos * costo_byte;
+        return movidos;
     }
 
-    void run_spn() {
-        int t = 0;
-        vector<Process*> pendientes;
-        for (auto &p : procesos) pendientes.push_back(&p);
-        sort(pendientes.begin(), pendientes.end(), [](Process* a, Process* b) {
-            return a->llegada < b->llegada;
-        });
-        vector<Process*> ready;
-        while (!pendientes.empty() || !ready.empty()) {
-            while (!pendientes.empty() && pendientes.front()->llegada <= t) {
-                ready.push_back(pendientes.front());
-                pendientes.erase(pendientes.begin());
-            }
-            if (ready.empty()) {
-                if (!pendientes.empty()) t = pendientes.front()->llegada;
-                continue;
-            }
-            sort(ready.begin(), ready.end(), [](Process* a, Process* b) {
-                return a->servicio < b->servicio;
-            });
-            Process* cur = ready.front();
-            ready.erase(ready.begin());
-            if (t < cur->llegada) t = cur->llegada;
-            cur->inicio = t;
-            cur->fin = t + cur->servicio;
-            t = cur->fin;
-        }
+    // Tiempo entero de compactacion e intercambio pendiente de cargar al reloj.
+    int cobrarDeuda() {
+        int c = (int)deuda_compactacion, x = (int)deuda_intercambio;
+        deuda_compactacion -= c;
+        deuda_intercambio -= x;
+        tiempo_compactacion += c;
+        tiempo_intercambio += x;
+        return c + x;
     }
 
-    void run_rr() {
-        int t = 0;
-        vector<Process*> pendientes;
-        for (auto &p : procesos) pendientes.push_back(&p);
-        sort(pendientes.begin(), pendientes.end(), [](Process* a, Process* b) {
-            return a->llegada < b->llegada;
-        });
-        deque<Process*> ready;
-        while (!pendientes.empty() || !ready.empty()) {
-            while (!pendientes.empty() && pendientes.front()->llegada <= t) {
-                ready.push_back(pendientes.front());
-                pendientes.erase(pendientes.begin());
-            }
-            if (ready.empty()) {
-                if (!pendientes.empty()) t = pendientes.front()->llegada;
-                continue;
-            }
-            Process* cur = ready.front();
-            ready.pop_front();
-            if (cur->inicio == -1) cur->inicio = t;
-            int use = min(quantum, cur->restante);
-            t += use;
-            cur->restante -= use;
-            while (!pendientes.empty() && pendientes.front()->llegada <= t) {
-                ready.push_back(pendientes.front());
-                pendientes.erase(pendientes.begin());
-            }
-            if (cur->restante == 0) cur->fin = t;
-            else ready.push_back(cur);
-        }
+    int paginasDe(int tam) const { return (tam + tam_pagina - 1) / tam_pagina; }
+
+    void prepararPaginacion() {
+        int marcos = memoria_size / tam_pagina;
+        marcos_libres.resize(marcos);
+        for (int f = 0; f < marcos; ++f) marcos_libres[f] = marcos - 1 - f;  // se toman desde el 0
+        tp_ini.assign(procesos.size() + 1, 0);
+        for (auto &r : solicitudes_mem)
+            if (int i = indiceDe(r.pid); i != -1) tp_ini[i + 1] += paginasDe(r.tam);
+        partial_sum(tp_ini.begin(), tp_ini.end(), tp_ini.begin());
+        tabla_paginas.assign(tp_ini.back(), -1);
+        tp_usadas.assign(procesos.size(), 0);
     }
 
-    void print_results() {
-        cout << "\nPID | Llegada | Servicio | Inicio | Fin | Respuesta | Espera | Retorno\n";
-        cout << "----+---------+----------+--------+-----+-----------+--------+--------\n";
-        double sumaResp=0, sumaEsp=0, sumaRet=0;
-        int maxFin = 0;
-        for (auto &p : procesos) {
-            cout << setw(3) << p.pid << " | "
-                 << setw(7) << p.llegada << " | "
-                 << setw(8) << p.servicio << " | "
-                 << setw(6) << p.inicio << " | "
-                 << setw(3) << p.fin << " | "
-                 << setw(9) << p.respuesta() << " | "
-                 << setw(6) << p.espera() << " | "
-                 << setw(6) << p.retorno() << "\n";
-            sumaResp += p.respuesta();
-            sumaEsp += p.espera();
-            sumaRet += p.retorno();
-            if (p.fin > maxFin) maxFin = p.fin;
-        }
-        int n = procesos.size();
-        cout << fixed << setprecision(2);
-        cout << "\nPromedio respuesta \t=\t " << (sumaResp / n) << "\n";
-        cout << "Promedio espera     \t=\t " << (sumaEsp / n) << "\n";
-        cout << "Promedio retorno   \t=\t " << (sumaRet / n) << "\n";
-        double throughput = (double)n / max(1, maxFin);
-        cout << "Throughput         \t=\t " << throughput << " procesos/unidad\n";
+    // Devuelve la primera pagina virtual de la solicitud dentro de la tabla del proceso.
+    int alloc_paginas(int pid, int tam) {
+        int i = indiceDe(pid), np = paginasDe(tam);
+        if (i == -1 || np > (int)marcos_libres.size()) return -1;
+        int v = tp_usadas[i];
+        int *tp = &tabla_paginas[tp_ini[i] + v];
+        for (int k = 0; k < np; ++k) { tp[k] = marcos_libres.back(); marcos_libres.pop_back(); }
+        tp_usadas[i] += np;
+        frag_interna += (long long)np * tam_pagina - tam;
+        bytes_paginados += tam;
+        return v;
     }
 
-    void print_memory() {
-        cout << "\nMemoria total: " << memoria_size
+    void free_pages_by_pid(int pid) {
+        int i = indiceDe(pid);
+        if (i == -1) return;
+        for (int k = 0; k < tp_usadas[i]; ++k) marcos_libres.push_back(tabla_paginas[tp_ini[i] + k]);
+        tp_usadas[i] = 0;
+    }
+
+    int asignar(int pid, int tam) {
+        PERFIL_CONTAR(asignaciones, 1);
+        if (tam_pagina > 0) return alloc_paginas(pid, tam);
+        if (!costo_asignacion.empty()) {
+            auto t0 = chrono::steady_clock::now();
+            int id = asignarContigua(pid, tam);
+            CostoAsignacion &c = costo_asignacion[(int)alg_mem];
+            c.ns.agregar(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count());
+            c.bloques.agregar(revisados);
+            return id;
+        }
+        return asignarContigua(pid, tam);
+    }
+
+    int asignarContigua(int pid, int tam) {
+        if (alg_mem == AlgMem::FIRST_FIT) return alloc_first_fit(pid, tam);
+        if (alg_mem == AlgMem::BEST_FIT) return alloc_best_fit(pid, tam);
+        if (alg_mem == AlgMem::WORST_FIT) return alloc_worst_fit(pid, tam);
+        return alloc_next_fit(pid, tam);
+    }
+
+    void assign_memory_requests() {
+        PERFIL_FASE(MEMORIA);
+        for (auto &req : solicitudes_mem) atender(req);
+    }
+
+    void atender(MemReq &req) {
+        req.block_id = asignar(req.pid, req.tam);
+        if (req.block_id == -1 && tam_pagina == 0 && libreTotal() >= req.tam) {
+            if (compactacion != Compactacion::NO) {
+                compactar(req.tam);
+                req.block_id = asignar(req.pid, req.tam);
+            }
+            if (req.block_id == -1) fallidas_frag++;
+        }
+        if (req.block_id == -1) mem_fallidas++;
+        else {
+            mem_asignadas++;
+            if (int i = indiceDe(req.pid); i != -1) procesos[i].mem += req.tam;
+        }
+        muestrearMemoria();
+    }
+
+    // Indice en procesos de un pid (procesos esta ordenado por llegada, no por pid).
+    vector<int> idx_por_pid;   // pares (pid, indice) aplanados y ordenados por pid
+    void indexarPids() {
+        vector<pair<int,int>> v(procesos.size());
+        for (int i = 0; i < (int)procesos.size(); ++i) v[i] = {procesos[i].pid, i};
+        sort(v.begin(), v.end());
+        PERFIL_CONTAR(ordenamientos, 1);
+        idx_por_pid.resize(2 * v.size());
+        for (size_t k = 0; k < v.size(); ++k) { idx_por_pid[2*k] = v[k].first; idx_por_pid[2*k+1] = v[k].second; }
+    }
+    int indiceDe(int pid) const {
+        int lo = 0, hi = (int)idx_por_pid.size() / 2;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (idx_por_pid[2*mid] < pid) lo = mid + 1; else hi = mid;
+        }
+        if (lo < (int)idx_por_pid.size() / 2 && idx_por_pid[2*lo] == pid) return idx_por_pid[2*lo+1];
+        return -1;
+    }
+
+    // Eventos de memoria del modo TEMPORAL: las solicitudes sin tiempo se atienden
+    // al llegar su proceso, las demas en su instante, y todo se libera en Process::fin.
+    vector<int> mem_al_llegar;   // indices de solicitudes sin tiempo, ordenados por pid
+    vector<int> mem_con_tiempo;  // indices de solicitudes con tiempo, ordenados por tiempo
+    size_t sig_mem = 0;
+
+    void prepararEventosMem() {
+        mem_al_llegar.clear(); mem_con_tiempo.clear(); mem_diferidas.clear(); sig_mem = 0;
+        for (int k = 0; k < (int)solicitudes_mem.size(); ++k)
+            (solicitudes_mem[k].tiempo < 0 ? mem_al_llegar : mem_con_tiempo).push_back(k);
+        stable_sort(mem_al_llegar.begin(), mem_al_llegar.end(), [&](int a, int b) {
+            return solicitudes_mem[a].pid < solicitudes_mem[b].pid;
+        });
+        stable_sort(mem_con_tiempo.begin(), mem_con_tiempo.end(), [&](int a, int b) {
+            return solicitudes_mem[a].tiempo < solicitudes_mem[b].tiempo;
+        });
+        PERFIL_CONTAR(ordenamientos, 2);
+    }
+
+    pair<vector<int>::iterator, vector<int>::iterator> solicitudesAlLlegar(int pid) {
+        auto it = lower_bound(mem_al_llegar.begin(), mem_al_llegar.end(), pid, [&](int k, int p) {
+            return solicitudes_mem[k].pid < p;
+        });
+        auto fin = it;
+        while (fin != mem_al_llegar.end() && solicitudes_mem[*fin].pid == pid) ++fin;
+        return {it, fin};
+    }
+
+    void memAlLlegar(Process &p) {
+        if (en_flujo) {   // las del bloque en curso, en orden de pid como las llegadas
+            auto &sol = flujo.solicitudes;
+            for (; flujo.sig_sol < sol.size() && sol[flujo.sig_sol].pid == p.pid; flujo.sig_sol++) {
+                MemReq &req = sol[flujo.sig_sol];
+                atender(req);
+                if (req.block_id != -1) p.mem += req.tam;   // sin idx_por_pid atender no lo anota
+            }
+            return;
+        }
+        auto r = solicitudesAlLlegar(p.pid);
+        for (auto it = r.first; it != r.second; ++it) atender(solicitudes_mem[*it]);
+    }
+
+    // Control de admision: reserva todas las solicitudes al llegar o ninguna.
+    // Un proceso se reintenta cada vez que se libera memoria, asi que los
+    // intentos no cuentan fallas ni toman muestras: la falla la cuenta bloquear,
+    // una vez por proceso, y la muestra se toma si la reserva entra completa.
+    bool fallo_por_frag = false;   // el ultimo intento fallido tenia libre suficiente
+    bool reservar(Process &p) {
+        long long fallidas = mem_fallidas, frag = fallidas_frag;
+        sin_muestreo = true;
+        bool ok = intentarReservar(p);
+        sin_muestreo = false;
+        fallo_por_frag = !ok && fallidas_frag > frag;
+        mem_fallidas = fallidas;
+        fallidas_frag = frag;
+        if (ok) muestrearMemoria();
+        return ok;
+    }
+
+    // Con varias solicitudes se guarda la memoria para deshacer un intento parcial.
+    bool intentarReservar(Process &p) {
+        auto r = solicitudesAlLlegar(p.pid);
+        if (tam_pagina > 0) {   // con paginas basta contar marcos
+            long long np = 0;
+            for (auto it = r.first; it != r.second; ++it) np += paginasDe(solicitudes_mem[*it].tam);
+            if (np > (long long)marcos_libres.size()) return false;
+            for (auto it = r.first; it != r.second; ++it) atender(solicitudes_mem[*it]);
+            return true;
+        }
+        if (r.second - r.first > 1) {
+            vector<Block> copia = memoria;
+            int lp = last_pos, mem = p.mem;
+            long long ok = mem_asignadas;
+            // una compactacion del intento se deshace junto con la memoria
+            long long nc = compactaciones, movidos = bytes_movidos;
+            double deuda = deuda_compactacion;
+            for (auto it = r.first; it != r.second; ++it) {
+                atender(solicitudes_mem[*it]);
+                if (solicitudes_mem[*it].block_id == -1) {
+                    memoria.swap(copia);
+                    last_pos = lp;
+                    p.mem = mem;
+                    mem_asignadas = ok;
+                    compactaciones = nc;
+                    bytes_movidos = movidos;
+                    deuda_compactacion = deuda;
+                    for (auto jt = r.first; jt != r.second; ++jt) solicitudes_mem[*jt].block_id = -1;
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (r.first == r.second) return true;
+        atender(solicitudes_mem[*r.first]);
+        return solicitudes_mem[*r.first].block_id != -1;
+    }
+
+    // Bloqueados por memoria en orden de llegada, con la mayor solicitud de cada
+    // uno. Se admiten estrictamente en ese orden y un recien llegado no pasa
+    // delante de ellos: uno grande no espera para siempre detras de una serie de
+    // chicos, a costa de que los chicos esperen al grande.
+    deque<pair<int, int>> bloqueados;   // (mayor solicitud, indice del proceso)
+
+    void bloquear(int i) {
+        int mayor = 0;
+        auto r = solicitudesAlLlegar(procesos[i].pid);
+        for (auto it = r.first; it != r.second; ++it) mayor = max(mayor, solicitudes_mem[*it].tam);
+        bloqueados.emplace_back(mayor, i);
+        mem_fallidas++;
+        if (fallo_por_frag) fallidas_frag++;
+    }
+
+    long long mayorHueco() const {
+        if (tam_pagina > 0) return libreTotal();
+        int m = 0;
+        for (auto &b : memoria) if (b.libre && b.tam > m) m = b.tam;
+        return m;
+    }
+
+    // Admision: reserva la memoria del proceso y lo deja residente.
+    bool cargar(int i) {
+        if (!reservar(procesos[i])) return false;
+        procesos[i].admitido = true;
+        if (victima != Victima::NINGUNA) {
+            pos_residente[i] = residentes.size();
+            residentes.push_back(i);
+        }
+        auto [a, b] = mem_diferidas.equal_range(i);   // ya puede recibir las que llegaron antes
+        for (auto it = a; it != b; ++it) atender(solicitudes_mem[it->second]);
+        mem_diferidas.erase(a, b);
+        return true;
+    }
+
+    void descargar(int i) {
+        if (victima == Victima::NINGUNA || pos_residente[i] == -1) return;
+        int u = residentes.back();
+        residentes[pos_residente[i]] = u;
+        pos_residente[u] = pos_residente[i];
+        residentes.pop_back();
+        pos_residente[i] = -1;
+    }
+
+    // Suspende residentes segun la politica hasta que el proceso i pueda cargarse.
+    // Solo se intenta si lo que liberarian todos los residentes alcanza.
+    bool cargarConIntercambio(int i) {
+        if (cargar(i)) return true;
+        if (victima == Victima::NINGUNA) return false;
+        long long necesario = 0, disponible = libreTotal();
+        auto r = solicitudesAlLlegar(procesos[i].pid);
+        for (auto it = r.first; it != r.second; ++it) necesario += solicitudes_mem[*it].tam;
+        for (int k : residentes) disponible += procesos[k].mem;
+        if (disponible < necesario) return false;
+        while (!residentes.empty()) {
+            int v = residentes[0];
+            for (int k : residentes) {
+                const Process &a = procesos[k], &b = procesos[v];
+                bool mejor;
+                if (victima == Victima::PRIORIDAD) mejor = a.prioridad != b.prioridad ? a.prioridad > b.prioridad : a.mem > b.mem;
+                else if (victima == Victima::ESPERA) mejor = a.listo_desde < b.listo_desde;
+                else mejor = a.mem > b.mem;
+                if (mejor) v = k;
+            }
+            Process &pv = procesos[v];
+            bytes_intercambiados += pv.mem;
+            deuda_intercambio += pv.mem * costo_intercambio;
+            descargar(v);
+            liberar(pv);
+            pv.suspendido = true;
+            suspensiones++;
+            suspendidos.push_back(v);
+            if (cargar(i)) return true;
+        }
+        return false;
+    }
+
+    void despertar(int t) {
+        // Primero vuelven los suspendidos que entren, en el orden en que salieron;
+        // uno que no entra queda en la cola sin frenar a los que le siguen.
+        for (size_t k = suspendidos.size(); k > 0; --k) {
+            int i = suspendidos.front();
+            Process &p = procesos[i];
+            suspendidos.pop_front();
+            if (p.fin != -1) continue;   // un terminado no vuelve a memoria
+            if (!cargar(i)) {
+                suspendidos.push_back(i);
+                continue;
+            }
+            p.suspendido = false;
+            reanudaciones++;
+            bytes_intercambiados += p.mem;
+            deuda_intercambio += p.mem * costo_intercambio;
+            if (!p.en_cola && !p.en_io) encolar(i, t);
+        }
+        if (bloqueados.empty()) return;
+        // Con compactacion basta con que alcance el total libre.
+        auto limite = [&]() -> long long {
+            return compactacion != Compactacion::NO ? libreTotal() : mayorHueco();
+        };
+        while (!bloqueados.empty() && bloqueados.front().first <= limite()) {
+            int i = bloqueados.front().second;
+            if (!cargar(i)) break;
+            bloqueados.pop_front();
+            procesos[i].espera_mem = t - procesos[i].llegada;
+            encolar(i, t);
+        }
+    }
+
+    // Solicitudes con tiempo < hasta; las de procesos ya terminados se descartan.
+    // Con control de admision las de un proceso que no esta en memoria (sin
+    // llegar, bloqueado o suspendido) esperan a que se cargue: fuera de
+    // residentes el intercambio no podria recuperarlas.
+    multimap<int, int> mem_diferidas;   // (indice del proceso, solicitud)
+
+    void memConTiempo(int hasta) {
+        while (sig_mem < mem_con_tiempo.size() && solicitudes_mem[mem_con_tiempo[sig_mem]].tiempo < hasta) {
+            int k = mem_con_tiempo[sig_mem++];
+            int i = indiceDe(solicitudes_mem[k].pid);
+            if (i != -1 && procesos[i].fin != -1) continue;
+            if (admision && i != -1 && (!procesos[i].admitido || procesos[i].suspendido)) mem_diferidas.emplace(i, k);
+            else atender(solicitudes_mem[k]);
+        }
+    }
+
+    void liberar(Process &p) {
+        if (p.mem == 0) return;
+        if (tam_pagina > 0) free_pages_by_pid(p.pid);
+        else free_block_by_pid(p.pid);
+        p.mem = 0;
+        mem_liberaciones++;
+    }
+
+    // Schedulers
+    void run() {
+        simular();
+        {
+            PERFIL_FASE(IMPRESION);
+            if (solo_resumen) print_en_linea();
+            else if (formato == Formato::JSON) print_json();
+            else if (formato == Formato::CSV) print_csv();
+            else print_tablas();
+        }
+#ifdef SIM_PERFIL
+        print_perfil(solo_resumen || formato == Formato::TABLA ? cout : cerr);   // JSON y CSV quedan limpios
+#endif
+    }
+
+    void print_tablas() {
+        print_results();
+        print_memory();
+        if (!costo_asignacion.empty()) print_costo_asignacion();
+        if (serie_cada > 0 && tam_pagina == 0) print_fragmentacion();
+        if (gantt) cout << "\nGantt: " << gantt->tramos() << " despachos escritos en " << archivo_gantt << "\n";
+        if (memoria_virtual) print_reemplazo();
+    }
+
+    // Simulacion completa sin imprimir; el estado queda en procesos y memoria.
+    void simular() {
+        if (paralelo && !en_paralelo && memoriaIndependiente()) { simularEnParalelo(); return; }
+        iniciarSimulacion();
+        avanzar(INT_MAX);
+        terminarSimulacion();
+    }
+
+    // simular() en partes: entre iniciar y terminar la linea de tiempo puede
+    // avanzarse por tramos, y el Simulator copiarse en cualquier pausa.
+    void iniciarSimulacion() {
+        if (!procesos_ordenados) ordenar_procesos();
+        if (modo_mem == ModoMem::TEMPORAL || tam_pagina > 0) indexarPids();
+        if (tam_pagina > 0) prepararPaginacion();
+        if (modo_mem == ModoMem::INICIAL) assign_memory_requests();
+        iniciarPlanificacion(alg_cpu);
+    }
+
+    // En modo inicial sin costo de compactacion la asignacion no influye en el
+    // planificador: solo escribe memoria, solicitudes_mem, sus contadores y
+    // Process::mem, que la linea de tiempo no lee.
+    bool memoriaIndependiente() const {
+        return modo_mem == ModoMem::INICIAL && !admision
+            && (compactacion == Compactacion::NO || costo_byte == 0);
+    }
+
+    // Igual que simular(), con assign_memory_requests en su propio hilo mientras
+    // corre la linea de tiempo. Cada hilo escribe estado distinto, asi que el
+    // resultado es el mismo que el secuencial.
+    void simularEnParalelo() {
+        if (!procesos_ordenados) ordenar_procesos();
+        if (tam_pagina > 0) {
+            indexarPids();
+            prepararPaginacion();
+        }
+        thread mem([this] { assign_memory_requests(); });
+        iniciarPlanificacion(alg_cpu);
+        avanzar(INT_MAX);
+        mem.join();
+        terminarSimulacion();
+    }
+
+    void terminarSimulacion() {
+        terminarPlanificacion();
+        if (gantt) gantt->cerrar();
+        if (memoria_virtual) simularReemplazo();
+    }
+
+    // Pagina densa de cada (proceso, pagina): base_pagina[i] + pagina.
+    void prepararTraza() {
+        base_pagina.assign(procesos.size() + 1, 0);
+        paraleloPara(procesos.size(), [&](size_t i) {
+            const Process &p = procesos[i];
+            int m = -1;
+            for (int k = 0; k < p.ref_n; ++k) m = max(m, referencias[p.ref_ini + k]);
+            base_pagina[i + 1] = m + 1;
+        });
+        partial_sum(base_pagina.begin(), base_pagina.end(), base_pagina.begin());
+        traza.clear();
+        traza.reserve(referencias.size());
+    }
+
+    // Las referencias se emiten en proporcion al servicio ya ejecutado.
+    void emitirReferencias(const Process &p, int use) {
+        if (p.ref_n == 0 || p.servicio == 0) return;
+        long long hecho = p.servicio - p.restante;
+        int desde = (int)((long long)p.ref_n * (hecho - use) / p.servicio);
+        int hasta = (int)((long long)p.ref_n * hecho / p.servicio);
+        int base = base_pagina[&p - procesos.data()];
+        for (int k = desde; k < hasta; ++k) traza.push_back(base + referencias[p.ref_ini + k]);
+    }
+
+    void simularReemplazo() {
+        PERFIL_FASE(REEMPLAZO);
+        int paginas = base_pagina.empty() ? 0 : base_pagina.back();
+        resultados_reemplazo.assign(algs_reemplazo.size(), {});
+        // El TLB es un trabajo mas junto a los algoritmos de reemplazo.
+        paraleloPara(algs_reemplazo.size() + con_tlb, [&](size_t k) {
+            auto t0 = chrono::steady_clock::now();
+            if (k == algs_reemplazo.size()) {
+                tlb_aciertos = tlb.aciertos(traza);
+                tlb_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+                return;
+            }
+            long long f = Reemplazo::fallos(algs_reemplazo[k], traza, paginas, marcos_virtuales);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            resultados_reemplazo[k] = {algs_reemplazo[k], f, ms};
+        });
+    }
+
+    void run_fcfs() { planificar(AlgCPU::FCFS); }
+    void run_spn() { planificar(AlgCPU::SPN); }
+    void run_rr() { planificar(AlgCPU::RR); }
+
+    // Cola de listos con indices en procesos: FIFO para FCFS/RR, menor servicio
+    // para SPN (empates por orden de llegada).
+    struct ColaListos {
+        AlgCPU alg;
+        bool por_pid = false;   // en flujo el indice es una ranura: los empates van por pid
+        deque<int> fifo;
+        priority_queue<tuple<int,int,int>, vector<tuple<int,int,int>>, greater<tuple<int,int,int>>> spn;
+        explicit ColaListos(AlgCPU a, bool por_pid = false) : alg(a), por_pid(por_pid) {}
+        bool empty() const { return alg == AlgCPU::SPN ? spn.empty() : fifo.empty(); }
+        void push(int i, const Process &p) {
+            // SPN ordena por la rafaga de CPU que sigue y, a igual rafaga, por orden de llegada
+            if (alg == AlgCPU::SPN) spn.push({p.raf_n ? p.raf_resto : p.servicio, por_pid ? p.pid : i, i});
+            else fifo.push_back(i);
+        }
+        int pop() {
+            int i;
+            if (alg == AlgCPU::SPN) { i = get<2>(spn.top()); spn.pop(); }
+            else { i = fifo.front(); fifo.pop_front(); }
+            return i;
+        }
+    };
+    ColaListos listos{AlgCPU::FCFS};
+
+    void encolar(int i, int t) {
+        Process &p = procesos[i];
+        if (p.suspendido) return;
+        p.en_cola = true;
+        p.listo_desde = t;
+        listos.push(i, p);
+        PERFIL_CONTAR(encolados, 1);
+    }
+
+    // Linea de tiempo comun a los tres algoritmos. FCFS y SPN corren cada proceso
+    // hasta terminar; RR lo corre a lo mas un quantum y lo devuelve al final de la
+    // cola despues de los que llegaron durante su turno.
+    void planificar(AlgCPU alg) {
+        iniciarPlanificacion(alg);
+        avanzar(INT_MAX);
+        terminarPlanificacion();
+    }
+
+    // Estado de la linea de tiempo entre tramos de avanzar().
+    int reloj = 0;
+    int sig_llegada = 0;   // proximo proceso por llegar
+
+    // Carga en flujo: el generador entrega un bloque a la vez y cada llegada
+    // ocupa en procesos la ranura de uno ya terminado, asi la memoria depende
+    // de los procesos vivos y no del total.
+    struct Flujo {
+        size_t bloque = 0;            // proximo bloque a generar
+        double t = 0;                 // instante en que termina el ultimo bloque generado
+        vector<Process> pendientes;   // bloque en curso, en orden de llegada
+        size_t sig = 0;
+        vector<MemReq> solicitudes;   // del bloque en curso, en orden de pid
+        size_t sig_sol = 0;
+        vector<int> libres;           // ranuras de procesos terminados
+    } flujo;
+
+    void generarBloqueFlujo() {
+        Flujo &f = flujo;
+        f.pendientes.clear();
+        f.solicitudes.clear();
+        f.sig = f.sig_sol = 0;
+        size_t ini = f.bloque * Generador::BLOQUE;
+        if (ini >= (size_t)generador.n) return;
+        Generador::Totales tot = generador.contarBloque(f.bloque);
+        f.pendientes.assign(min<size_t>(generador.n - ini, Generador::BLOQUE), Process{});
+        f.solicitudes.assign(tot.m, MemReq{});
+        generador.generarBloque(f.bloque, f.t, 0, 0, f.pendientes.data(), f.solicitudes.data(),
+                                nullptr, nullptr, memoria_size);
+        f.t += tot.t;
+        f.bloque++;
+        if (modo_mem == ModoMem::INICIAL) for (auto &req : f.solicitudes) atender(req);
+    }
+
+    bool hayLlegadas() const {
+        return en_flujo ? flujo.sig < flujo.pendientes.size() : sig_llegada < (int)procesos.size();
+    }
+    int proximaLlegada() const {
+        return en_flujo ? flujo.pendientes[flujo.sig].llegada : procesos[sig_llegada].llegada;
+    }
+    // Indice en procesos del proximo en llegar; en flujo se copia a una ranura,
+    // lo que puede mover procesos (no guardar referencias a traves de admitir).
+    int ranuraLlegada() {
+        if (!en_flujo) return sig_llegada;
+        const Process &p = flujo.pendientes[flujo.sig];
+        if (flujo.libres.empty()) {
+            procesos.push_back(p);
+            return (int)procesos.size() - 1;
+        }
+        int i = flujo.libres.back();
+        flujo.libres.pop_back();
+        procesos[i] = p;
+        return i;
+    }
+    void consumirLlegada() {
+        if (!en_flujo) { sig_llegada++; return; }
+        if (++flujo.sig == flujo.pendientes.size()) generarBloqueFlujo();
+    }
+
+    void iniciarPlanificacion(AlgCPU alg) {
+        if (modo_mem == ModoMem::TEMPORAL) prepararEventosMem();
+        if (memoria_virtual) prepararTraza();
+        bloqueados.clear();
+        suspendidos.clear();
+        residentes.clear();
+        pos_residente.assign(victima != Victima::NINGUNA ? procesos.size() : 0, -1);
+        sig_llegada = 0;
+        if (en_flujo) {
+            procesos.clear();
+            flujo = Flujo{};
+            generarBloqueFlujo();
+        }
+        listos = ColaListos(alg, en_flujo);
+        prepararIO();
+        reloj = cobrarDeuda();
+    }
+
+    // Al terminar la linea de tiempo ya nadie libera memoria: toda la que tenian
+    // los residentes se devolvio, asi que los suspendidos y bloqueados que quedan
+    // no entran ni con la memoria vacia. Quedan sin fin y resumen() los cuenta.
+    void terminarPlanificacion() {
+        if (modo_mem == ModoMem::TEMPORAL) memConTiempo(INT_MAX);
+    }
+
+    bool planificacionTerminada() const {
+        return !hayLlegadas() && listos.empty() && fin_io.empty();
+    }
+
+    // Cambia el planificador a mitad de la linea de tiempo; la cola de listos se
+    // rearma en el orden en que la antigua la habria despachado.
+    void cambiarPlanificador(AlgCPU alg) {
+        ColaListos nueva(alg, listos.por_pid);
+        while (!listos.empty()) {
+            int i = listos.pop();
+            nueva.push(i, procesos[i]);
+        }
+        listos = move(nueva);
+        alg_cpu = alg;
+    }
+
+    // Admite las llegadas con llegada < hasta, en orden de tiempo junto con
+    // las solicitudes de memoria con tiempo y los fines de E/S.
+    void admitir(int hasta) {
+        bool temporal = modo_mem == ModoMem::TEMPORAL;
+        while (true) {
+            bool hay_llegada = hayLlegadas() && proximaLlegada() < hasta;
+            bool hay_io = !fin_io.empty() && fin_io.top().first < hasta;
+            if (!hay_llegada && !hay_io) break;
+            PERFIL_CONTAR(eventos, 1);
+            if (hay_io && (!hay_llegada || fin_io.top().first < proximaLlegada())) {
+                terminarIO();
+                continue;
+            }
+            if (temporal) memConTiempo(proximaLlegada() + 1);
+            int sig = ranuraLlegada();
+            if (admision) {
+                if (!bloqueados.empty()) {   // espera su turno detras de los bloqueados
+                    fallo_por_frag = false;
+                    bloquear(sig);
+                } else if (cargarConIntercambio(sig)) encolar(sig, procesos[sig].llegada);
+                else bloquear(sig);
+            } else {
+                if (temporal) memAlLlegar(procesos[sig]);
+                encolar(sig, procesos[sig].llegada);
+            }
+            consumirLlegada();
+        }
+        if (temporal) memConTiempo(hasta);
+    }
+
+    // Despacha mientras quede trabajo y el reloj no haya llegado a hasta; el
+    // turno en curso se completa aunque termine despues.
+    void avanzar(int hasta) {
+        PERFIL_FASE(PLANIFICADOR);
+        bool temporal = modo_mem == ModoMem::TEMPORAL;
+        int &t = reloj;
+        while (!planificacionTerminada() && t < hasta) {
+            admitir(t + 1);
+            if (int c = cobrarDeuda()) { t += c; continue; }  // la CPU compacta o intercambia
+            if (listos.empty()) {
+                int prox = INT_MAX;
+                if (hayLlegadas()) prox = proximaLlegada();
+                if (!fin_io.empty()) prox = min(prox, fin_io.top().first);
+                t = max(t, prox);
+                continue;
+            }
+            int i = listos.pop();
+            PERFIL_CONTAR(despachos, 1);
+            Process &cur = procesos[i];
+            cur.en_cola = false;
+            if (cur.suspendido) continue;   // la entrada quedo de antes de suspenderlo
+            if (cur.inicio == -1) cur.inicio = t;
+            int rafaga = cur.raf_n ? cur.raf_resto : cur.restante;
+            int use = listos.alg == AlgCPU::RR ? min(quantum, rafaga) : rafaga;
+            if (gantt) gantt->agregar(cur.pid, t, use);
+            t += use;
+            cur.restante -= use;
+            cur.raf_resto -= use;
+            cpu_ocupada += use;
+            if (memoria_virtual) emitirReferencias(cur, use);
+            // Si termino ya no es candidato a intercambio, aunque conserve su
+            // memoria hasta despues de las llegadas del turno.
+            if (cur.restante == 0 && victima != Victima::NINGUNA) descargar(i);
+            admitir(t);           // lo ocurrido durante el turno; en flujo cur puede moverse
+            if (procesos[i].restante == 0) {
+                Process &p = procesos[i];
+                p.fin = t;
+                if (solo_resumen) en_linea.agregar(p);
+                if (temporal) liberar(p);
+                if (admision) despertar(t);
+            }
+            admitir(t + 1);       // llegadas justo en t, despues de liberar
+            if (Process &p = procesos[i]; p.restante > 0) {
+                if (p.raf_n && p.raf_resto == 0) pedirIO(i, t);
+                else encolar(i, t);
+            } else if (en_flujo) flujo.libres.push_back(i);   // la ranura queda para otra llegada
+        }
+    }
+
+    void prepararIO() {
+        fin_io = decltype(fin_io)();
+        for (auto &d : dispositivos) d.reiniciar();
+        atendiendo.assign(dispositivos.size(), -1);
+        pedido_io.assign(rafagas.empty() ? 0 : procesos.size(), 0);
+        cpu_ocupada = 0;
+        for (auto &p : procesos) {
+            p.raf_actual = 0;
+            if (p.raf_n) p.raf_resto = rafagas[p.raf_ini].dur;
+        }
+    }
+
+    // Fin de una rafaga de CPU: el proceso pasa a la cola de su dispositivo.
+    void pedirIO(int i, int t) {
+        Process &p = procesos[i];
+        const Rafaga &r = rafagas[p.raf_ini + p.raf_actual + 1];
+        p.en_io = true;
+        pedido_io[i] = t;
+        dispositivos[r.disp].agregar(i, r.pista);
+        if (atendiendo[r.disp] == -1) iniciarIO(r.disp, t);
+    }
+
+    void iniciarIO(int d, int t) {
+        Dispositivo &dev = dispositivos[d];
+        if (dev.vacia()) return;
+        auto [i, busqueda] = dev.siguiente();
+        const Process &p = procesos[i];
+        int dur = rafagas[p.raf_ini + p.raf_actual + 1].dur + busqueda;
+        dev.espera_cola += t - pedido_io[i];
+        dev.ocupado += dur;
+        dev.atendidas++;
+        atendiendo[d] = i;
+        fin_io.push({t + dur, d});
+    }
+
+    // Fin de E/S mas proximo: el proceso vuelve a listos con su siguiente rafaga.
+    void terminarIO() {
+        auto [t, d] = fin_io.top();
+        fin_io.pop();
+        int i = atendiendo[d];
+        atendiendo[d] = -1;
+        Process &p = procesos[i];
+        p.io += t - pedido_io[i];
+        p.en_io = false;
+        p.raf_actual += 2;
+        p.raf_resto = rafagas[p.raf_ini + p.raf_actual].dur;
+        if (!p.en_cola) encolar(i, t);
+        iniciarIO(d, t);
+    }
+
+    // Promedios de print_results; los procesos sin fin quedan fuera: los nunca
+    // admitidos y los varados (admitidos, suspendidos y nunca reanudados).
+    struct Resumen {
+        int n = 0, sin_memoria = 0, varados = 0, max_fin = 0;
+        double respuesta = 0, espera = 0, retorno = 0, espera_mem = 0, throughput = 0;
+    };
+
+    Resumen resumen() const {
+        Resumen r;
+        double sumaResp=0, sumaEsp=0, sumaRet=0, sumaMem=0;
+        for (auto &p : procesos) {
+            if (p.fin == -1) { (p.admitido ? r.varados : r.sin_memoria)++; continue; }
+            sumaMem += p.espera_mem;
+            sumaResp += p.respuesta();
+            sumaEsp += p.espera();
+            sumaRet += p.retorno();
+            if (p.fin > r.max_fin) r.max_fin = p.fin;
+        }
+        r.n = procesos.size() - r.sin_memoria - r.varados;
+        r.respuesta = sumaResp / max(1, r.n);
+        r.espera = sumaEsp / max(1, r.n);
+        r.retorno = sumaRet / max(1, r.n);
+        r.espera_mem = sumaMem / max(1, r.n);
+        r.throughput = (double)r.n / max(1, r.max_fin);
+        return r;
+    }
+
+    void print_results() {
+        print_procesos();
+        Resumen r = resumen();
+        print_promedios(r);
+        if (r.n > 0) print_percentiles();
+        if (!dispositivos.empty()) print_io(r.max_fin);
+        if (admision) {
+            cout << "Espera por memoria \t=\t " << r.espera_mem << "\n";
+            cout << "Nunca admitidos    \t=\t " << r.sin_memoria << "\n";
+            cout << "Varados            \t=\t " << r.varados << "\n";
+        }
+    }
+
+    void print_procesos() const {
+        Escritor w(cout);
+        w.texto("\nPID | Llegada | Servicio | Inicio | Fin | Respuesta | Espera | Retorno\n");
+        w.texto("----+---------+----------+--------+-----+-----------+--------+--------\n");
+        for (auto &p : procesos) {
+            w.entero(p.pid, 3).texto(" | ")
+             .entero(p.llegada, 7).texto(" | ")
+             .entero(p.servicio, 8).texto(" | ")
+             .entero(p.inicio, 6).texto(" | ");
+            if (p.fin == -1) {   // sin fin no hay metricas que calcular
+                w.texto(p.admitido ? "varado\n" : "no admitido\n");
+                continue;
+            }
+            w.entero(p.fin, 3).texto(" | ")
+             .entero(p.respuesta(), 9).texto(" | ")
+             .entero(p.espera(), 6).texto(" | ")
+             .entero(p.retorno(), 6).texto("\n");
+        }
+    }
+
+    // --output csv: una fila por proceso, para planillas y scripts.
+    void print_csv() const {
+        Escritor w(cout);
+        w.texto("pid,llegada,servicio,inicio,fin,respuesta,espera,retorno,espera_mem\n");
+        for (auto &p : procesos) {
+            w.entero(p.pid).texto(",").entero(p.llegada).texto(",").entero(p.servicio).texto(",")
+             .entero(p.inicio).texto(",");
+            if (p.fin == -1) w.texto(",,,");   // no admitido o varado: metricas vacias
+            else w.entero(p.fin).texto(",").entero(p.respuesta()).texto(",")
+                  .entero(p.espera()).texto(",").entero(p.retorno()).texto(",");
+            w.entero(p.espera_mem).texto("\n");
+        }
+    }
+
+    // --output json: procesos, promedios y estado final de la memoria.
+    void print_json() const {
+        Escritor w(cout);
+        w.texto("{\"procesos\":[");
+        for (size_t k = 0; k < procesos.size(); ++k) {
+            const Process &p = procesos[k];
+            w.texto(k ? ",\n{\"pid\":" : "\n{\"pid\":").entero(p.pid)
+             .texto(",\"llegada\":").entero(p.llegada)
+             .texto(",\"servicio\":").entero(p.servicio)
+             .texto(",\"inicio\":").entero(p.inicio);
+            if (p.fin == -1)   // no admitido o varado: metricas nulas
+                w.texto(",\"fin\":null,\"respuesta\":null,\"espera\":null,\"retorno\":null,\"estado\":\"")
+                 .texto(p.admitido ? "varado\"" : "no_admitido\"");
+            else w.texto(",\"fin\":").entero(p.fin)
+                  .texto(",\"respuesta\":").entero(p.respuesta())
+                  .texto(",\"espera\":").entero(p.espera())
+                  .texto(",\"retorno\":").entero(p.retorno());
+            w.texto(",\"espera_mem\":").entero(p.espera_mem).texto("}");
+        }
+        Resumen r = resumen();
+        w.texto("],\n\"promedios\":{\"respuesta\":").real(r.respuesta)
+         .texto(",\"espera\":").real(r.espera)
+         .texto(",\"retorno\":").real(r.retorno)
+         .texto(",\"throughput\":").real(r.throughput, 4)
+         .texto(",\"nunca_admitidos\":").entero(r.sin_memoria)
+         .texto(",\"varados\":").entero(r.varados).texto("},\n");
+        w.texto("\"memoria\":{\"tam\":").entero(memoria_size)
+         .texto(",\"estrategia\":\"").texto(algMemToStr(alg_mem))
+         .texto("\",\"tam_pagina\":").entero(tam_pagina)
+         .texto(",\"asignadas\":").entero(mem_asignadas)
+         .texto(",\"fallidas\":").entero(mem_fallidas)
+         .texto(",\"fallidas_frag\":").entero(fallidas_frag)
+         .texto(",\"liberaciones\":").entero(mem_liberaciones)
+         .texto(",\"bloques\":[");
+        if (tam_pagina == 0) {
+            for (size_t k = 0; k < memoria.size(); ++k) {
+                const Block &b = memoria[k];
+                w.texto(k ? ",\n{\"id\":" : "\n{\"id\":").entero(b.id)
+                 .texto(",\"inicio\":").entero(b.inicio)
+                 .texto(",\"tam\":").entero(b.tam)
+                 .texto(b.libre ? ",\"libre\":true" : ",\"libre\":false")
+                 .texto(",\"pid\":").entero(b.pid_asignado).texto("}");
+            }
+        }
+        w.texto("],\n\"solicitudes\":[");
+        for (size_t k = 0; k < solicitudes_mem.size(); ++k) {
+            const MemReq &q = solicitudes_mem[k];
+            w.texto(k ? ",\n{\"pid\":" : "\n{\"pid\":").entero(q.pid)
+             .texto(",\"tam\":").entero(q.tam)
+             .texto(",\"block_id\":").entero(q.block_id).texto("}");
+        }
+        w.texto("]}}\n");
+    }
+
+    // Cola de la distribucion, en total y separando procesos cortos (servicio
+    // hasta la mediana) de largos: el promedio esconde la inanicion de SPN.
+    void print_percentiles() const {
+        vector<int> servicios;
+        for (auto &p : procesos) if (p.fin != -1) servicios.push_back(p.servicio);
+        int mediana = percentiles(servicios, {0.5})[0];
+        cout << "\nPercentiles (cortos: servicio <= " << mediana << "):\n";
+        cout << "\n  Metrica   | Clase  |   p50    |   p90    |   p99    |  p99.9   |   max\n";
+        cout << "------------+--------+----------+----------+----------+----------+----------\n";
+        const pair<const char *, int (Process::*)() const> metricas[] = {
+            {"Respuesta", &Process::respuesta}, {"Espera", &Process::espera}, {"Retorno", &Process::retorno}};
+        for (auto &[nombre, f] : metricas) {
+            vector<int> todos, cortos, largos;
+            for (auto &p : procesos) {
+                if (p.fin == -1) continue;
+                int v = (p.*f)();
+                todos.push_back(v);
+                (p.servicio <= mediana ? cortos : largos).push_back(v);
+            }
+            const pair<const char *, vector<int> *> clases[] = {{"Todos", &todos}, {"Cortos", &cortos}, {"Largos", &largos}};
+            for (auto &[clase, v] : clases) {
+                cout << setw(11) << nombre << " | " << setw(6) << clase;
+                if (v->empty()) cout << " |        - |        - |        - |        - |        -\n";
+                else {
+                    for (int x : percentiles(*v, {0.5, 0.9, 0.99, 0.999, 1.0})) cout << " | " << setw(8) << x;
+                    cout << "\n";
+                }
+            }
+        }
+    }
+
+    void print_en_linea() const {
+        const EnLinea &e = en_linea;
+        cout << "\nResumen: " << e.n << " procesos terminados, "
+             << (en_flujo ? generador.n : (long long)procesos.size()) - e.n << " sin terminar\n";
+        if (e.n == 0) return;   // sin promedios ni percentiles que mostrar
+        Resumen r;
+        r.respuesta = e.suma_resp / e.n;
+        r.espera = e.suma_esp / e.n;
+        r.retorno = e.suma_ret / e.n;
+        r.throughput = (double)e.n / max(1, e.max_fin);
+        print_promedios(r);
+        cout << "\n  Metrica   |   p50    |   p90    |   p99    |  p99.9   |   max\n";
+        cout << "------------+----------+----------+----------+----------+----------\n";
+        auto fila = [](const char *nombre, const Histograma &h) {
+            cout << setw(11) << nombre;
+            for (double q : {0.5, 0.9, 0.99, 0.999}) cout << " | " << setw(8) << h.percentil(q);
+            cout << " | " << setw(8) << h.maximo << "\n";
+        };
+        fila("Respuesta", e.resp);
+        fila("Espera", e.esp);
+        fila("Retorno", e.ret);
+    }
+
+    static void print_promedios(const Resumen &r) {
+        cout << fixed << setprecision(2);
+        cout << "\nPromedio respuesta \t=\t " << r.respuesta << "\n";
+        cout << "Promedio espera     \t=\t " << r.espera << "\n";
+        cout << "Promedio retorno   \t=\t " << r.retorno << "\n";
+        cout << "Throughput         \t=\t " << r.throughput << " procesos/unidad\n";
+    }
+
+#ifdef SIM_PERFIL
+    void print_perfil(ostream &os) const {
+        const char *fases[] = {"Carga", "Memoria", "Planificador", "Reemplazo", "Impresion"};
+        os << "\nPerfil:\n";
+        os << "Bloques revisados  \t=\t " << perfil.bloques_revisados << "\n";
+        os << "Asignaciones       \t=\t " << perfil.asignaciones << "\n";
+        os << "Divisiones         \t=\t " << perfil.divisiones << "\n";
+        os << "Fusiones           \t=\t " << perfil.fusiones << "\n";
+        os << "Encolados          \t=\t " << perfil.encolados << "\n";
+        os << "Despachos          \t=\t " << perfil.despachos << "\n";
+        os << "Ordenamientos      \t=\t " << perfil.ordenamientos << "\n";
+        os << "Eventos            \t=\t " << perfil.eventos << "\n";
+        os << fixed << setprecision(3);
+        for (int f = 0; f < Perfil::N_FASES; ++f)
+            os << "Fase " << left << setw(13) << fases[f] << right << "\t=\t " << perfil.ms[f] << " ms\n";
+    }
+#endif
+
+    void print_memory() {
+        if (tam_pagina > 0) { print_paginas(); return; }
+        cout << "\nMemoria total: " << memoria_size
              << " bytes. Estrategia: " << algMemToStr(alg_mem) << "\n";
 
         cout << "\nBloques:\n";
         cout << "\n id  | inicio |  tamano  | libre |  pid\n";
         cout << "-----+--------+----------+-------+-----\n";
-        for (auto &b : memoria) {
-            cout << setw(4) << b.id << " | "
-                 << setw(6) << b.inicio << " | "
-                 << setw(8) << b.tam << " | "
-                 << setw(5) << (b.libre ? "SI" : "NO") << " | "
-                 << setw(3) << b.pid_asignado << "\n";
+        {
+            Escritor w(cout);
+            for (auto &b : memoria) {
+                w.entero(b.id, 4).texto(" | ")
+                 .entero(b.inicio, 6).texto(" | ")
+                 .entero(b.tam, 8).texto(" | ")
+                 .texto(b.libre ? "   SI | " : "   NO | ")
+                 .entero(b.pid_asignado, 3).texto("\n");
+            }
         }
 
+        long long libre = libreTotal(), externa = libre - mayorHueco();
+        cout << "\nFragmentacion externa: " << externa << " bytes ("
+             << fixed << setprecision(2) << (libre ? 100.0 * externa / libre : 0.0)
+             << "% del libre), fallidas por fragmentacion: " << fallidas_frag << "\n";
+
+        if (compactacion != Compactacion::NO) {
+            cout << "\nCompactaciones: " << compactaciones << "  bytes movidos: " << bytes_movidos
+                 << "  tiempo cargado: " << tiempo_compactacion << "\n";
+        }
+        print_contadores_mem();
+
         cout << "\nSolicitudes de memoria:\n";
         cout << "\n pid |    tam   | block_id\n";
         cout << "-----+----------+----------\n";
+        Escritor w(cout);
+        for (auto &r : solicitudes_mem) {
+            w.entero(r.pid, 4).texto(" | ")
+             .entero(r.tam, 8).texto(" | ")
+             .entero(r.block_id, 8).texto("\n");
+        }
+    }
+
+    void print_costo_asignacion() const {
+        for (AlgMem m : {AlgMem::FIRST_FIT, AlgMem::BEST_FIT, AlgMem::WORST_FIT, AlgMem::NEXT_FIT}) {
+            const CostoAsignacion &c = costo_asignacion[(int)m];
+            if (c.bloques.n == 0) continue;
+            cout << "\nCosto por asignacion (" << algMemToStr(m) << "): " << c.bloques.n << " llamadas\n";
+            cout << "\n  Medida   |   p50    |   p90    |   p99    |   max\n";
+            cout << "----------+----------+----------+----------+----------\n";
+            auto fila = [](const char *nombre, const Histograma &h) {
+                cout << setw(9) << nombre;
+                for (double q : {0.5, 0.9, 0.99}) cout << " | " << setw(8) << h.percentil(q);
+                cout << " | " << setw(8) << h.maximo << "\n";
+            };
+            fila("Bloques", c.bloques);
+            fila("ns", c.ns);
+            print_histograma("Bloques revisados", c.bloques);
+        }
+    }
+
+    // Cuenta de un histograma por potencias de 2: 0, 1, 2-3, 4-7, ...
+    static void print_histograma(const char *titulo, const Histograma &h) {
+        vector<long long> pot(64, 0);
+        long long ceros = 0;
+        for (size_t k = 0; k < h.c.size(); ++k) {
+            if (!h.c[k]) continue;
+            long long inf = Histograma::inferior(k);
+            if (inf == 0) ceros += h.c[k];
+            else pot[63 - __builtin_clzll(inf)] += h.c[k];
+        }
+        cout << "\n " << setw(21) << left << titulo << right << " | Llamadas |   %\n";
+        cout << "-----------------------+----------+-------\n";
+        cout << fixed << setprecision(2);
+        auto fila = [&](const string &rango, long long n) {
+            cout << setw(22) << rango << " | " << setw(8) << n << " | " << setw(5) << 100.0 * n / h.n << "\n";
+        };
+        if (ceros) fila("0", ceros);
+        for (int e = 0; e < 64; ++e) {
+            if (!pot[e]) continue;
+            long long a = 1LL << e, b = (2LL << e) - 1;
+            fila(a == b ? to_string(a) : to_string(a) + "-" + to_string(b), pot[e]);
+        }
+    }
+
+    void print_fragmentacion() {
+        cout << "\nFragmentacion en el tiempo: " << eventos_mem << " eventos, una muestra cada "
+             << serie_cada << ", ultimas " << serie_frag.size() << "\n";
+        cout << "\n  Evento  |    t    | Externa | Mayor hueco | Huecos |  Uso\n";
+        cout << "----------+---------+---------+-------------+--------+-------\n";
+        cout << fixed << setprecision(2);
+        for (size_t k = 0; k < serie_frag.size(); ++k) {
+            const MuestraMem &m = serie_frag[k];
+            cout << setw(9) << m.evento << " | "
+                 << setw(7) << m.t << " | "
+                 << setw(6) << 100 * m.externa << "% | "
+                 << setw(11) << m.mayor << " | "
+                 << setw(6) << m.huecos << " | "
+                 << setw(5) << 100 * m.uso << "%\n";
+        }
+    }
+
+    void print_reemplazo() {
+        cout << "\nMemoria virtual: " << traza.size() << " referencias, "
+             << (base_pagina.empty() ? 0 : base_pagina.back()) << " paginas";
+        if (!algs_reemplazo.empty()) cout << ", " << marcos_virtuales << " marcos";
+        cout << "\n";
+        if (con_tlb) print_tlb();
+        if (resultados_reemplazo.empty()) return;
+        cout << "\n Algoritmo |   Fallos   | Tasa fallos | Tiempo (ms)\n";
+        cout << "-----------+------------+-------------+------------\n";
+        for (auto &r : resultados_reemplazo) {
+            cout << setw(10) << Reemplazo::nombre(r.alg) << " | "
+                 << setw(10) << r.fallos << " | "
+                 << setw(10) << fixed << setprecision(2)
+                 << (traza.empty() ? 0.0 : 100.0 * r.fallos / traza.size()) << "% | ";
+            if (sin_tiempos) cout << setw(10) << "-" << "\n";
+            else cout << setw(10) << r.ms << "\n";
+        }
+    }
+
+    void print_tlb() {
+        static const char *pol[] = {"LRU", "FIFO", "aleatoria"};
+        double tasa = traza.empty() ? 0.0 : (double)tlb_aciertos / traza.size();
+        double eat = tlb.t_tlb + tlb.t_memoria + (1 - tasa) * tlb.t_memoria;
+        cout << "\nTLB: " << tlb.conjuntos * tlb.vias << " entradas, " << tlb.vias << " vias, "
+             << pol[tlb.politica] << "\n";
+        cout << fixed << setprecision(2);
+        cout << "Aciertos TLB       \t=\t " << tlb_aciertos << " (" << 100 * tasa << "%)\n";
+        cout << "Tiempo efectivo    \t=\t " << eat << " (t_tlb " << tlb.t_tlb
+             << ", t_memoria " << tlb.t_memoria << ")\n";
+        if (!sin_tiempos) cout << "Tiempo simulacion  \t=\t " << tlb_ms << " ms\n";
+    }
+
+    void print_io(int maxFin) {
+        cout << "Utilizacion CPU    \t=\t " << 100.0 * cpu_ocupada / max(1, maxFin) << "%\n";
+        cout << "\n Dispositivo |  Politica | Atendidas | Utilizacion | Espera cola\n";
+        cout << "-------------+-----------+-----------+-------------+------------\n";
+        for (auto &d : dispositivos) {
+            cout << setw(12) << d.nombre << " | "
+                 << setw(9) << (d.ascensor ? "ascensor" : "FCFS") << " | "
+                 << setw(9) << d.atendidas << " | "
+                 << setw(10) << 100.0 * d.ocupado / max(1, maxFin) << "% | "
+                 << setw(10) << (d.atendidas ? (double)d.espera_cola / d.atendidas : 0.0) << "\n";
+        }
+    }
+
+    void print_contadores_mem() {
+        if (modo_mem != ModoMem::TEMPORAL) return;
+        cout << "\nAsignaciones: " << mem_asignadas << "  fallidas: " << mem_fallidas
+             << "  liberaciones: " << mem_liberaciones << "\n";
+        if (victima != Victima::NINGUNA) {
+            cout << "Suspensiones: " << suspensiones << "  reanudaciones: " << reanudaciones
+                 << "  bytes intercambiados: " << bytes_intercambiados
+                 << "  tiempo cargado: " << tiempo_intercambio << "\n";
+        }
+    }
+
+    void print_paginas() {
+        int marcos = memoria_size / tam_pagina;
+        cout << "\nMemoria total: " << memoria_size << " bytes. Paginacion: paginas de "
+             << tam_pagina << " bytes, " << marcos << " marcos (" << marcos_libres.size() << " libres)\n";
+        cout << "\nFragmentacion interna: " << frag_interna << " bytes ("
+             << fixed << setprecision(2)
+             << (bytes_paginados ? 100.0 * frag_interna / (bytes_paginados + frag_interna) : 0.0)
+             << "% de lo asignado)\n";
+        print_contadores_mem();
+
+        cout << "\nSolicitudes de memoria:\n";
+        cout << "\n pid |    tam   |  pagina  | paginas\n";
+        cout << "-----+----------+----------+--------\n";
         for (auto &r : solicitudes_mem) {
             cout << setw(4) << r.pid << " | "
                  << setw(8) << r.tam << " | "
-                 << setw(8) << r.block_id << "\n";
+                 << setw(8) << r.block_id << " | "
+                 << setw(7) << (r.block_id == -1 ? 0 : paginasDe(r.tam)) << "\n";
+        }
+
+        cout << "\nTabla de paginas (procesos con memoria asignada):\n";
+        for (size_t i = 0; i < procesos.size(); ++i) {
+            if (tp_usadas[i] == 0) continue;
+            cout << setw(4) << procesos[i].pid << " |";
+            for (int k = 0; k < tp_usadas[i]; ++k) cout << ' ' << tabla_paginas[tp_ini[i] + k];
+            cout << "\n";
         }
     }
 };
 
+// Una politica (planificador, estrategia de memoria, quantum) y su resultado.
+struct Combinacion {
+    AlgCPU cpu;
+    AlgMem mem;
+    int quantum;
+    Simulator::Resumen r;
+    long long asignadas, fallidas;
+
+    void aplicar(Simulator &sim) const {
+        sim.alg_cpu = cpu;
+        sim.alg_mem = mem;
+        if (cpu == AlgCPU::RR) sim.quantum = quantum;
+    }
+    void medir(const Simulator &sim) {
+        r = sim.resumen();
+        asignadas = sim.mem_asignadas;
+        fallidas = sim.mem_fallidas;
+    }
+};
+
+vector<Combinacion> combinaciones(const vector<AlgMem> &mems, int qmin, int qmax, int qpaso) {
+    vector<Combinacion> combs;
+    for (AlgCPU c : {AlgCPU::FCFS, AlgCPU::SPN, AlgCPU::RR})
+        for (AlgMem m : mems) {
+            if (c != AlgCPU::RR) { combs.push_back({c, m, 0, {}, 0, 0}); continue; }
+            for (int q = qmin; q <= qmax; q += qpaso) combs.push_back({c, m, q, {}, 0, 0});
+        }
+    return combs;
+}
+
+void imprimirCombinaciones(const vector<Combinacion> &combs) {
+    cout << "\n CPU  | Q  |  Memoria  | Respuesta |  Espera  | Retorno  | Throughput | Asignadas | Fallidas\n";
+    cout << "------+----+-----------+-----------+----------+----------+------------+-----------+---------\n";
+    cout << fixed << setprecision(2);
+    for (auto &c : combs) {
+        cout << setw(5) << algCPUToStr(c.cpu) << " | "
+             << setw(2) << (c.cpu == AlgCPU::RR ? to_string(c.quantum) : "-") << " | "
+             << setw(9) << algMemToStr(c.mem) << " | "
+             << setw(9) << c.r.respuesta << " | "
+             << setw(8) << c.r.espera << " | "
+             << setw(8) << c.r.retorno << " | "
+             << setw(10) << c.r.throughput << " | "
+             << setw(9) << c.asignadas << " | "
+             << setw(8) << c.fallidas << "\n";
+    }
+}
+
+const vector<AlgMem> TODAS_MEM = {AlgMem::FIRST_FIT, AlgMem::BEST_FIT, AlgMem::WORST_FIT, AlgMem::NEXT_FIT};
+
+// Barrido de parametros: simula cada combinacion de planificador, estrategia de
+// memoria y quantum (solo RR) sobre la misma carga. Cada combinacion es una copia
+// de la base, que comparte referencias y rafagas; los hilos toman combinaciones
+// de una cola comun.
+void barrido(const Simulator &base, int qmin, int qmax, int qpaso) {
+    vector<AlgMem> mems = TODAS_MEM;
+    if (base.tam_pagina > 0) mems = {base.alg_mem};   // con paginas la estrategia no cuenta
+    vector<Combinacion> combs = combinaciones(mems, qmin, qmax, qpaso);
+
+    paraleloPara(combs.size(), [&](size_t k) {
+        Simulator sim = base;
+        combs[k].aplicar(sim);
+        sim.simular();
+        combs[k].medir(sim);
+    });
+
+    cout << "\nBarrido: " << combs.size() << " combinaciones, " << base.procesos.size() << " procesos\n";
+    imprimirCombinaciones(combs);
+}
+
+// Particiones: grupos de procesos que no comparten nada (cada uno con su CPU,
+// su memoria del tamano del JSON y sus dispositivos). Cada grupo es un
+// Simulator aparte, simulado en paralelo; el reporte junta los procesos de
+// todos y agrega una fila por particion.
+bool hayParticiones(const Simulator &sim) {
+    for (auto &p : sim.procesos)
+        if (p.particion != sim.procesos[0].particion) return true;
+    return false;
+}
+
+// Solo imprime tablas: las salidas que suponen una unica simulacion se rechazan.
+void simularParticiones(Simulator &base) {
+    if (base.solo_resumen || base.formato != Formato::TABLA || !base.archivo_gantt.empty())
+        throw runtime_error("--output, --resumen y --gantt no se admiten con particiones");
+    if (!base.procesos_ordenados) base.ordenar_procesos();
+    base.indexarPids();
+    map<int, int> pos;   // clave de particion -> posicion en sims
+    for (auto &p : base.procesos) pos.emplace(p.particion, 0);
+    int k = 0;
+    for (auto &[clave, i] : pos) i = k++;
+
+    vector<vector<Process>> procs(pos.size());
+    vector<vector<MemReq>> sols(pos.size());
+    for (auto &p : base.procesos) procs[pos[p.particion]].push_back(p);   // siguen ordenados
+    for (auto &r : base.solicitudes_mem) {   // una solicitud de un pid desconocido va a la primera particion
+        int i = base.indiceDe(r.pid);
+        sols[i == -1 ? 0 : pos[base.procesos[i].particion]].push_back(r);
+    }
+    // La base ya no tiene carga ni indice (apuntaria a la lista completa): copia barata.
+    base.procesos = {};
+    base.solicitudes_mem = {};
+    base.idx_por_pid = {};
+    vector<Simulator> sims(pos.size(), base);
+    for (size_t i = 0; i < sims.size(); ++i) {
+        sims[i].procesos.swap(procs[i]);
+        sims[i].solicitudes_mem.swap(sols[i]);
+        sims[i].indexarPids();
+    }
+    paraleloPara(sims.size(), [&](size_t i) { sims[i].simular(); });
+
+    for (auto &s : sims) base.procesos.insert(base.procesos.end(), s.procesos.begin(), s.procesos.end());
+    base.ordenar_procesos();
+    base.print_procesos();
+    Simulator::print_promedios(base.resumen());
+
+    cout << "\nParticiones: " << sims.size() << "\n";
+    cout << "\n Particion | Procesos | Respuesta |  Espera  | Retorno  |  Fin   | Throughput | Asignadas | Fallidas\n";
+    cout << "-----------+----------+-----------+----------+----------+--------+------------+-----------+---------\n";
+    for (auto &[clave, i] : pos) {
+        const Simulator &s = sims[i];
+        Simulator::Resumen r = s.resumen();
+        cout << setw(10) << clave << " | "
+             << setw(8) << s.procesos.size() << " | "
+             << setw(9) << r.respuesta << " | "
+             << setw(8) << r.espera << " | "
+             << setw(8) << r.retorno << " | "
+             << setw(6) << r.max_fin << " | "
+             << setw(10) << r.throughput << " | "
+             << setw(9) << s.mem_asignadas << " | "
+             << setw(8) << s.mem_fallidas << "\n";
+    }
+    for (auto &[clave, i] : pos) {   // cada particion tiene su propia memoria
+        cout << "\nMemoria de la particion " << clave << ":\n";
+        sims[i].print_memory();
+    }
+}
+
+// Que pasaria si: simula con la politica del JSON hasta el instante t, guarda
+// esa pausa y sigue una copia por cada combinacion desde ahi, sin repetir el
+// tramo comun. La estrategia de memoria solo varia en modo temporal (en modo
+// inicial ya se asigno todo).
+void bifurcar(Simulator &base, int t, int qmin, int qmax, int qpaso) {
+    base.iniciarSimulacion();
+    base.avanzar(t);
+    int terminados = 0;
+    for (auto &p : base.procesos) terminados += p.fin != -1;
+
+    vector<AlgMem> mems = {base.alg_mem};
+    if (base.modo_mem == ModoMem::TEMPORAL && base.tam_pagina == 0) mems = TODAS_MEM;
+    vector<Combinacion> combs = combinaciones(mems, qmin, qmax, qpaso);
+
+    paraleloPara(combs.size(), [&](size_t k) {
+        Simulator sim = base;
+        combs[k].aplicar(sim);
+        sim.cambiarPlanificador(combs[k].cpu);
+        sim.avanzar(INT_MAX);
+        sim.terminarSimulacion();
+        combs[k].medir(sim);
+    });
+
+    cout << "\nBifurcacion en t = " << base.reloj << " (" << algCPUToStr(base.alg_cpu) << ", "
+         << algMemToStr(base.alg_mem) << "): " << terminados << " de " << base.procesos.size()
+         << " procesos terminados, " << combs.size() << " continuaciones\n";
+    imprimirCombinaciones(combs);
+}
+
+// Ajuste del quantum de RR: malla de quantums en [qmin, qmax] evaluada en
+// paralelo, que se achica alrededor del mejor hasta paso 1. Cada evaluacion
+// copia la base ya cargada; los quantums ya simulados no se repiten.
+void ajustarQuantum(const Simulator &base, const string &metrica, int qmin, int qmax) {
+    double Simulator::Resumen::*campo;
+    bool maximizar = false;
+    if (metrica == "respuesta") campo = &Simulator::Resumen::respuesta;
+    else if (metrica == "espera") campo = &Simulator::Resumen::espera;
+    else if (metrica == "retorno") campo = &Simulator::Resumen::retorno;
+    else if (metrica == "throughput") { campo = &Simulator::Resumen::throughput; maximizar = true; }
+    else throw runtime_error("Metrica desconocida: " + metrica);
+    if (qmax < qmin) throw runtime_error("Rango de quantums vacio");
+
+    map<int, double> valores;
+    auto mejor = [&](int a, int b) {   // empate: el quantum menor
+        double va = valores[a], vb = valores[b];
+        if (va != vb) return maximizar ? va > vb : va < vb;
+        return a < b;
+    };
+    int puntos = max(8u, thread::hardware_concurrency());
+    int lo = qmin, hi = qmax, q_mejor = qmin;
+    for (;;) {
+        int paso = max(1, (hi - lo) / (puntos - 1));
+        vector<int> qs;
+        for (int q = lo; q <= hi; q += paso) if (!valores.count(q)) qs.push_back(q);
+        if (!valores.count(hi) && (qs.empty() || qs.back() != hi)) qs.push_back(hi);
+        vector<double> vs(qs.size());
+        paraleloPara(qs.size(), [&](size_t k) {
+            Simulator sim = base;
+            sim.alg_cpu = AlgCPU::RR;
+            sim.quantum = qs[k];
+            sim.simular();
+            vs[k] = sim.resumen().*campo;
+        });
+        for (size_t k = 0; k < qs.size(); ++k) valores[qs[k]] = vs[k];
+        for (int q = lo; q <= hi; q += paso) if (mejor(q, q_mejor)) q_mejor = q;
+        if (mejor(hi, q_mejor)) q_mejor = hi;
+        if (paso == 1) break;
+        lo = max(lo, q_mejor - paso);
+        hi = min(hi, q_mejor + paso);
+    }
+
+    cout << "\nAjuste de quantum (" << metrica << "), rango " << qmin << ".." << qmax
+         << ", " << valores.size() << " simulaciones\n";
+    cout << "\n Q    | " << setw(10) << metrica << "\n";
+    cout << "------+-----------\n";
+    cout << fixed << setprecision(maximizar ? 4 : 2);
+    for (auto &[q, v] : valores)
+        cout << setw(5) << q << " | " << setw(10) << v << (q == q_mejor ? "  <- mejor" : "") << "\n";
+    cout << "\nQuantum optimo \t=\t " << q_mejor << "\n";
+}
+
+// Monte Carlo: la misma configuracion con n semillas consecutivas del generador.
+// Cada corrida genera y simula su carga en un solo hilo (los paraleloPara internos
+// quedan anidados), asi las corridas escalan con los nucleos.
+void montecarlo(Simulator &base, int n) {
+    if (!base.con_generador) throw runtime_error("--montecarlo necesita una seccion \"generador\"");
+    base.procesos = {};           // cada corrida genera la suya: no copiar la carga de la base
+    base.solicitudes_mem = {};
+    base.referencias = {};
+    base.rafagas = {};
+    uint64_t semilla0 = base.generador.semilla;
+    vector<Simulator::Resumen> rs(n);
+    paraleloPara(n, [&](size_t k) {
+        Simulator sim = base;
+        sim.generador.semilla = semilla0 + k;
+        sim.generarCarga();
+        sim.simular();
+        rs[k] = sim.resumen();
+    });
+
+    // t de Student de dos colas al 95% para n-1 grados de libertad. Hasta 29 exacta;
+    // de 30 a 120 se interpola en 1/gl entre valores de tabla; la normal solo despues.
+    static const double T95[] = {0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+                                 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+                                 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045};
+    static const pair<int, double> T95_GL[] = {{30, 2.042}, {40, 2.021}, {50, 2.009}, {60, 2.000},
+                                               {80, 1.990}, {100, 1.984}, {120, 1.980}};
+    int gl = n - 1;
+    double t = 1.96;
+    if (gl < 30) t = T95[gl];
+    else if (gl <= 120) {
+        size_t k = 0;
+        while (T95_GL[k + 1].first < gl) ++k;
+        auto [a, ta] = T95_GL[k];
+        auto [b, tb] = T95_GL[k + 1];
+        t = ta + (tb - ta) * (1.0 / a - 1.0 / gl) / (1.0 / a - 1.0 / b);
+    }
+    cout << "\nMonte Carlo: " << n << " corridas, semillas " << semilla0 << " a " << semilla0 + n - 1 << "\n";
+    cout << "\n  Metrica   |   Media   | Desv. est. |       IC 95%\n";
+    cout << "------------+-----------+------------+---------------------\n";
+    cout << fixed << setprecision(2);
+    auto fila = [&](const char *nombre, double Simulator::Resumen::*campo, int dec) {
+        double suma = 0, suma2 = 0;
+        for (auto &r : rs) suma += r.*campo;
+        double media = suma / n;
+        for (auto &r : rs) suma2 += (r.*campo - media) * (r.*campo - media);
+        double desv = n > 1 ? sqrt(suma2 / (n - 1)) : 0;
+        double h = n > 1 ? t * desv / sqrt(n) : 0;
+        cout << setprecision(dec) << setw(11) << nombre << " | " << setw(9) << media << " | "
+             << setw(10) << desv << " | [" << media - h << ", " << media + h << "]\n";
+    };
+    fila("Respuesta", &Simulator::Resumen::respuesta, 2);
+    fila("Espera", &Simulator::Resumen::espera, 2);
+    fila("Retorno", &Simulator::Resumen::retorno, 2);
+    fila("Throughput", &Simulator::Resumen::throughput, 4);
+}
+
+// Microbenchmarks de los caminos calientes (--bench [max]): asignadores sobre
+// una memoria de n bloques y planificadores sobre n procesos, n = 10, 100, ...,
+// max. El exponente compara con el tamano anterior: 0 es constante, 1 lineal.
+void benchmark(long long max_n) {
+    using reloj = chrono::steady_clock;
+    auto ns = [](reloj::time_point t0, long long ops) {
+        return chrono::duration<double, nano>(reloj::now() - t0).count() / max(1LL, ops);
+    };
+    map<string, double> anterior;
+    auto fila = [&](const string &nombre, long long n, long long ops, double v) {
+        cout << setw(17) << left << nombre << right << " | " << setw(9) << n << " | "
+             << setw(8) << ops << " | " << setw(12) << setprecision(1) << v << " | ";
+        if (anterior.count(nombre)) cout << setw(9) << setprecision(2) << log10(v / anterior[nombre]) << "\n";
+        else cout << setw(9) << "-" << "\n";
+        anterior[nombre] = v;
+    };
+    cout << "\nOperacion         |     n     |   ops    |    ns/op     | Exponente\n";
+    cout << "------------------+-----------+----------+--------------+----------\n";
+    cout << fixed;
+    const pair<const char *, int (Simulator::*)(int, int)> asignadores[] = {
+        {"alloc_first_fit", &Simulator::alloc_first_fit}, {"alloc_best_fit", &Simulator::alloc_best_fit},
+        {"alloc_worst_fit", &Simulator::alloc_worst_fit}, {"alloc_next_fit", &Simulator::alloc_next_fit}};
+    const pair<const char *, AlgCPU> planificadores[] = {
+        {"run_fcfs", AlgCPU::FCFS}, {"run_spn", AlgCPU::SPN}, {"run_rr", AlgCPU::RR}};
+
+    for (long long n = 10; n <= max_n; n *= 10) {
+        // Memoria fragmentada: n bloques de 16 a 128 bytes alternando ocupado y
+        // libre, y un hueco grande al final.
+        Simulator base;
+        Rng r(n);
+        int inicio = 0;
+        for (long long i = 0; i < n; ++i) {
+            int tam = 16 + (int)(r() % 113);
+            bool libre = i % 2;
+            base.memoria.push_back({(int)i, inicio, tam, libre, libre ? -1 : (int)i + 1});
+            inicio += tam;
+        }
+        base.memoria.push_back({(int)n, inicio, 1 << 20, true, -1});
+        base.memoria_size = inicio + (1 << 20);
+        long long ops = max(3LL, min(1000LL, 10000000LL / n));
+
+        for (auto &[nombre, f] : asignadores) {
+            Simulator s = base;
+            auto t0 = reloj::now();
+            for (long long k = 0; k < ops; ++k) (s.*f)(-1 - (int)k, 100);
+            fila(nombre, n, ops, ns(t0, ops));
+        }
+        {
+            Simulator s = base;
+            auto t0 = reloj::now();
+            for (long long k = 0; k < ops; ++k) s.split_block(s.memoria.back(), -1 - (int)k, 64);
+            fila("split_block", n, ops, ns(t0, ops));
+        }
+        {
+            Simulator s = base;
+            long long ocupados = (n + 1) / 2;
+            auto t0 = reloj::now();
+            for (long long k = 0; k < ops; ++k) s.free_block_by_pid(1 + 2 * (int)(k % ocupados));
+            fila("free_block_by_pid", n, ops, ns(t0, ops));
+        }
+
+        // Planificadores: n procesos con llegadas de Poisson y servicio
+        // exponencial de media 10, con la CPU ocupada cerca del 90%.
+        Generador g;
+        g.n = n;
+        g.tasa = 0.09;
+        g.servicio.tipo = Distribucion::EXPONENCIAL;
+        g.servicio.a = 10;
+        Simulator carga;
+        g.generar(carga.procesos, carga.solicitudes_mem, carga.referencias.mut(), carga.rafagas.mut(), carga.memoria_size);
+        carga.procesos_ordenados = true;
+        for (auto &[nombre, alg] : planificadores) {
+            Simulator s = carga;
+            auto t0 = reloj::now();
+            s.planificar(alg);
+            fila(nombre, n, n, ns(t0, n));
+        }
+    }
+}
+
+// Pico de memoria residente del proceso en KB (VmHWM); 0 si el sistema no lo da.
+long long rssPicoKB() {
+    ifstream f("/proc/self/status");
+    string linea;
+    while (getline(f, linea))
+        if (linea.rfind("VmHWM:", 0) == 0) return atoll(linea.c_str() + 6);
+    return 0;
+}
+
+// Reinicia VmHWM al RSS actual (Linux >= 4.0) para medir el pico de cada caso por
+// separado; sin esto cada caso heredaria el pico del mas pesado anterior.
+void reiniciarRssPico() {
+    ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Regresion (--regresion dir): corre todos los configs de ejemplo y cargas
+// generadas de 10^4 a 10^6 procesos, compara la salida con dir/<caso>.txt y el
+// tiempo y el pico de RSS con dir/presupuestos.json. Con --actualizar reescribe
+// las referencias y fija cada presupuesto al doble de lo medido. Las referencias
+// versionadas viven en PU01_DAYAN_JAHUIRA/regresion (--regresion ../regresion desde
+// src). Devuelve la cantidad de casos que fallaron.
+int regresion(const string &dir_config, const string &dir, bool actualizar) {
+    struct Captura {   // cout va a os mientras viva
+        ostringstream os;
+        streambuf *viejo = cout.rdbuf(os.rdbuf());
+        ~Captura() { cout.rdbuf(viejo); }
+    };
+    struct Caso { string nombre; function<string()> correr; };
+    vector<Caso> casos;
+    for (string c : {"first", "best", "worst", "next", "io", "temporal", "virtual", "generador", "particiones"}) {
+        casos.push_back({"config_" + c, [=] {
+            Simulator sim;
+            sim.sin_tiempos = true;
+            sim.loadConfig(dir_config + "/config_" + c + ".json");
+            Captura cap;
+            if (hayParticiones(sim)) simularParticiones(sim);
+            else sim.run();
+            return cap.os.str();
+        }});
+    }
+    for (long long n : {10000LL, 100000LL, 1000000LL}) {
+        casos.push_back({"generado_" + to_string(n), [=] {
+            Simulator sim;
+            Generador g;
+            g.n = n;
+            g.tasa = 0.09;
+            g.servicio.tipo = Distribucion::EXPONENCIAL;
+            g.servicio.a = 10;
+            g.tam_mem.tipo = Distribucion::LOGNORMAL;
+            g.tam_mem.a = 9;
+            g.tam_mem.b = 1.2;
+            g.prob_mem = 1;
+            g.generar(sim.procesos, sim.solicitudes_mem, sim.referencias.mut(), sim.rafagas.mut(), sim.memoria_size);
+            sim.procesos_ordenados = true;
+            sim.memoria.push_back(Block{0, 0, sim.memoria_size, true, -1});   // lo que haria loadConfig
+            sim.modo_mem = ModoMem::TEMPORAL;   // asignar al llegar y liberar al terminar
+            sim.alg_cpu = AlgCPU::RR;
+            sim.simular();
+            Simulator::Resumen r = sim.resumen();
+            ostringstream os;
+            os << fixed << setprecision(4) << "procesos " << r.n << "\nrespuesta " << r.respuesta
+               << "\nespera " << r.espera << "\nretorno " << r.retorno << "\nthroughput " << r.throughput
+               << "\nasignadas " << sim.mem_asignadas << "\nfallidas " << sim.mem_fallidas << "\n";
+            return os.str();
+        }});
+    }
+
+    json presupuestos = json::object();
+    if (ifstream f(dir + "/presupuestos.json"); f) presupuestos = json::parse(f);
+    if (actualizar) filesystem::create_directories(dir);
+
+    int fallas = 0;
+    cout << "\n Caso               | Salida  |  Tiempo ms  | Presupuesto |  RSS MB  | Presupuesto\n";
+    cout << "--------------------+---------+-------------+-------------+----------+------------\n";
+    cout << fixed;
+    for (auto &c : casos) {
+        reiniciarRssPico();
+        auto t0 = chrono::steady_clock::now();
+        string salida = c.correr();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        double rss = rssPicoKB() / 1024.0;
+
+        string archivo = dir + "/" + c.nombre + ".txt";
+        string estado;
+        if (actualizar) {
+            ofstream(archivo, ios::binary) << salida;
+            presupuestos[c.nombre] = {{"ms", ceil(max(10.0, 2 * ms))}, {"rss_mb", ceil(max(16.0, 2 * rss))}};
+            estado = "nueva";
+        } else {
+            ifstream f(archivo, ios::binary);
+            string ref((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+            estado = !f ? "falta" : ref == salida ? "igual" : "DIFIERE";
+        }
+        bool falla = estado == "falta" || estado == "DIFIERE";
+        double max_ms = -1, max_rss = -1;
+        if (!actualizar && presupuestos.contains(c.nombre)) {
+            max_ms = presupuestos[c.nombre].value("ms", -1.0);
+            max_rss = presupuestos[c.nombre].value("rss_mb", -1.0);
+        }
+        bool lento = max_ms >= 0 && ms > max_ms, pesado = max_rss >= 0 && rss > max_rss;
+        falla = falla || lento || pesado;
+        fallas += falla;
+
+        auto limite = [](double v) { return v < 0 ? string("-") : to_string((long long)v); };
+        cout << setprecision(1) << " " << setw(18) << left << c.nombre << right << " | " << setw(7) << estado << " | "
+             << setw(11) << ms << " | " << setw(11) << limite(max_ms) << (lento ? "!" : " ") << "| "
+             << setw(8) << rss << " | " << setw(11) << limite(max_rss) << (pesado ? "!" : "") << "\n";
+    }
+    if (actualizar) ofstream(dir + "/presupuestos.json") << presupuestos.dump(2) << "\n";
+    cout << "\n" << (fallas ? to_string(fallas) + " casos fallaron" : string("Todo en orden")) << "\n";
+    return fallas;
+}
+
 int main(int argc, char** argv) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
@@ -346,14 +3019,106 @@ int main(int argc, char** argv) {
 //    string cfg = "../config/config_next.json";
 //    string cfg = "../config/config_best.json";
 //    string cfg = "../config/config_worst.json";
-    if (argc >= 2) cfg = argv[1];
     Simulator sim;
+    bool modo_barrido = false;
+    int qmin = 1, qmax = 8, qpaso = 1, corridas = 0, t_bifurcacion = -1;
+    bool con_quantums = false;
+    string metrica_ajuste;
+    long long bench_max = 0;
+    string dir_regresion;
+    bool actualizar = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--cache") sim.usar_cache = true;
+        else if (arg == "--barrido") modo_barrido = true;
+        else if (arg == "--paralelo") sim.paralelo = true;
+        else if (arg == "--resumen") sim.solo_resumen = true;
+        else if (arg == "--regresion" && i + 1 < argc) dir_regresion = argv[++i];
+        else if (arg == "--actualizar") actualizar = true;
+        else if (arg == "--costo-asignacion") sim.costo_asignacion.resize(4);
+        else if (arg == "--output" && i + 1 < argc) {
+            string f = argv[++i];
+            if (f == "json") sim.formato = Formato::JSON;
+            else if (f == "csv") sim.formato = Formato::CSV;
+            else if (f == "table") sim.formato = Formato::TABLA;
+            else {
+                cerr << "Error: --output espera json, csv o table\n";
+                return 1;
+            }
+        }
+        else if (arg == "--gantt" && i + 1 < argc) sim.archivo_gantt = argv[++i];
+        else if (arg == "--fragmentacion") {   // [cada[:capacidad]], por defecto 1:1000
+            int cada = 1, cap = 1000;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) sscanf(argv[++i], "%d:%d", &cada, &cap);
+            sim.serie_cada = max(1, cada);
+            sim.serie_frag = Anillo<Simulator::MuestraMem>(max(1, cap));
+        }
+        else if (arg == "--bench") {   // tamano maximo opcional, 10^6 por defecto
+            bench_max = 1000000;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) bench_max = atoll(argv[++i]);
+        }
+        else if (arg == "--montecarlo" && i + 1 < argc) {
+            corridas = atoi(argv[++i]);
+            if (corridas < 1) {
+                cerr << "Error: --montecarlo espera la cantidad de corridas\n";
+                return 1;
+            }
+        }
+        else if (arg == "--bifurcar" && i + 1 < argc) t_bifurcacion = max(0, atoi(argv[++i]));
+        else if (arg == "--ajustar-quantum" && i + 1 < argc) metrica_ajuste = argv[++i];
+        else if (arg == "--quantums" && i + 1 < argc) {   // ini:fin[:paso]
+            con_quantums = true;
+            if (sscanf(argv[++i], "%d:%d:%d", &qmin, &qmax, &qpaso) < 2 || qmin < 1 || qpaso < 1) {
+                cerr << "Error: --quantums espera ini:fin[:paso]\n";
+                return 1;
+            }
+        }
+        else cfg = arg;
+    }
+    if (bench_max > 0) {
+        benchmark(bench_max);
+        return 0;
+    }
+    if (!dir_regresion.empty()) {   // los configs de ejemplo se buscan junto a cfg
+        try {
+            string dir_config = filesystem::path(cfg).parent_path().string();
+            return regresion(dir_config.empty() ? "." : dir_config, dir_regresion, actualizar) ? 1 : 0;
+        } catch (exception &e) {
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // Solo una corrida simple puede prescindir de la carga completa.
+    sim.en_flujo = sim.solo_resumen && corridas == 0 && metrica_ajuste.empty() && t_bifurcacion < 0 && !modo_barrido;
     try {
         sim.loadConfig(cfg);
     } catch (exception &e) {
         cerr << "Error: " << e.what() << "\n";
         return 1;
     }
-    sim.run();
+    try {
+        if (corridas > 0) montecarlo(sim, corridas);
+        else if (!metrica_ajuste.empty()) {
+            if (!con_quantums) {   // por defecto hasta el servicio mas largo: mas alla RR es FCFS
+                qmin = 1;
+                qmax = 1;
+                for (auto &p : sim.procesos) qmax = max(qmax, p.servicio);
+            }
+            ajustarQuantum(sim, metrica_ajuste, qmin, qmax);
+        }
+        else if (t_bifurcacion >= 0) {
+            if (!con_quantums) qmin = qmax = sim.quantum;
+            bifurcar(sim, t_bifurcacion, qmin, qmax, qpaso);
+        }
+        else if (modo_barrido) barrido(sim, qmin, qmax, qpaso);
+        else if (hayParticiones(sim)) simularParticiones(sim);
+        else {
+            if (!sim.archivo_gantt.empty()) sim.gantt = make_shared<TrazaGantt>(sim.archivo_gantt);
+            sim.run();
+        }
+    } catch (exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
     return 0;
 }